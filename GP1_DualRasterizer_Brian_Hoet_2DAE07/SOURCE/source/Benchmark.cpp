@@ -0,0 +1,496 @@
+#include "pch.h"
+#include "SoftwareRenderer.h"
+#include "Texture.h"
+#include "MaterialTexture.h"
+#include "Utils.h"
+#include "Profiler.h"
+
+//Standard includes
+#include <array>
+#include <fstream>
+#include <string_view>
+
+#undef main
+
+using namespace dae;
+
+//Headless benchmark of the software renderer. Every run flies the same scripted camera path,
+//so two builds can be compared frame for frame. Run it from the folder that holds Resources.
+//
+//Benchmark [--frames N] [--warmup N] [--resolutions 640x480,1920x1080] [--threads 1,4,0]
+//          [--shading forward|prepass|visibility] [--filter point|linear|anisotropic] [--mip none|nearest|linear]
+//          [--address wrap|clamp] [--layouts linear,tiled] [--motion orbit|spin]
+//          [--resources DIR] [--csv FILE] [--json FILE] [--trace FILE] [--verify]
+//--verify renders the last frame of every run again with each shading path, they all have to give the same checksum
+//--layouts runs everything once per texel layout of the material, both render the same frames
+//--motion spin keeps the camera still and turns the vehicle like the app does, orbit flies the camera around it
+//--trace writes the profiler zones once every run is done, the ring buffers keep the last frames
+
+namespace
+{
+	enum class Motion
+	{
+		Orbit,
+		Spin
+	};
+
+	struct Options
+	{
+		int nrFrames{ 600 };
+		int nrWarmupFrames{ 30 };
+		std::vector<Int2> resolutions{ { 640, 480 } };
+		std::vector<uint32_t> threadCounts{ 0 }; //0 = one thread per hardware core
+		SoftwareRenderer::ShadingPath shadingPath{ SoftwareRenderer::ShadingPath::Forward };
+		SamplerState samplerState{};
+		std::vector<TextureSampling::TexelLayout> layouts{ TextureSampling::TexelLayout::Tiled };
+		Motion motion{ Motion::Orbit };
+		std::string resourcePath{ "Resources" };
+		std::string csvPath{};
+		std::string jsonPath{};
+		std::string tracePath{};
+		bool verifyShadingPaths{ false };
+	};
+
+	//Milliseconds
+	struct Summary
+	{
+		double mean{};
+		double p50{};
+		double p95{};
+		double p99{};
+		double max{};
+	};
+
+	//The frame is wall clock time, the pipeline stages are thread time summed over all threads
+	constexpr std::array<PipelineStage, 5> TIMED_STAGES{ PipelineStage::Transform, PipelineStage::Setup, PipelineStage::Raster, PipelineStage::Shade, PipelineStage::Resolve };
+	constexpr int NR_STAGES{ 1 + static_cast<int>(TIMED_STAGES.size()) };
+
+	const char* GetStageName(int stage)
+	{
+		return stage == 0 ? "Frame" : StageTimers::GetName(TIMED_STAGES[stage - 1]);
+	}
+
+	struct Run
+	{
+		int width{};
+		int height{};
+		uint32_t nrThreads{};
+		TextureSampling::TexelLayout layout{};
+		uint32_t checksum{}; //of the last frame, equal between runs of the same build
+		std::array<Summary, NR_STAGES> stages{};
+	};
+
+	std::array<double, NR_STAGES> GetStageTimes(const SoftwareRenderer& renderer)
+	{
+		std::array<double, NR_STAGES> stageTimes{ renderer.GetFrameMilliseconds() };
+		for (int stage{ 1 }; stage < NR_STAGES; ++stage)
+		{
+			stageTimes[stage] = renderer.GetStageTimers().GetMilliseconds(TIMED_STAGES[stage - 1]);
+		}
+		return stageTimes;
+	}
+
+	//Nearest rank percentiles, sorts the samples
+	Summary Summarize(std::vector<double>& samples)
+	{
+		std::sort(samples.begin(), samples.end());
+
+		const auto percentile = [&samples](double fraction)
+			{
+				const size_t rank{ static_cast<size_t>(std::ceil(fraction * samples.size())) };
+				return samples[std::clamp<size_t>(rank, 1, samples.size()) - 1];
+			};
+
+		Summary summary{};
+		for (double sample : samples)
+		{
+			summary.mean += sample;
+		}
+		summary.mean /= samples.size();
+		summary.p50 = percentile(.50);
+		summary.p95 = percentile(.95);
+		summary.p99 = percentile(.99);
+		summary.max = samples.back();
+		return summary;
+	}
+
+	//One orbit around the vehicle over the whole run, swinging in close twice so some frames are fill bound
+	void PlaceCamera(Camera& camera, const Vector3& target, int frame, int nrFrames)
+	{
+		const float progress{ float(frame) / nrFrames };
+		const float angle{ progress * 2.f * PI };
+		const float distance{ 45.f + 25.f * cosf(2.f * angle) };
+		const float height{ 10.f + 6.f * sinf(3.f * angle) };
+
+		camera.origin = target + Vector3{ sinf(angle) * distance, height, -cosf(angle) * distance };
+		camera.forward = (target - camera.origin).Normalized();
+		camera.right = Vector3::Cross(camera.up, camera.forward);
+		camera.CalculateViewMatrix();
+		camera.CalculateProjectionMatrix();
+	}
+
+	//Two turns around its up axis over the whole run, in front of the camera at the origin
+	void SpinVehicle(MeshRasterizer& mesh, const Vector3& position, int frame, int nrFrames)
+	{
+		const float angle{ float(frame) / nrFrames * 4.f * PI };
+		mesh.worldMatrix = Matrix::CreateRotationY(angle) * Matrix::CreateTranslation(position);
+	}
+
+	const char* GetLayoutName(TextureSampling::TexelLayout layout)
+	{
+		return layout == TextureSampling::TexelLayout::Linear ? "linear" : "tiled";
+	}
+
+	uint32_t GetChecksum(const std::vector<uint32_t>& pixels)
+	{
+		//FNV-1a over the pixels
+		uint32_t hash{ 2166136261u };
+		for (uint32_t pixel : pixels)
+		{
+			hash = (hash ^ pixel) * 16777619u;
+		}
+		return hash;
+	}
+
+	template<typename T>
+	bool ParseList(std::string_view text, std::vector<T>& values, bool(*parseValue)(const std::string&, T&))
+	{
+		values.clear();
+		std::stringstream stream{ std::string{ text } };
+		for (std::string item; std::getline(stream, item, ',');)
+		{
+			if (!parseValue(item, values.emplace_back()))
+				return false;
+		}
+		return !values.empty();
+	}
+
+	bool ParseResolution(const std::string& text, Int2& resolution)
+	{
+		char separator{};
+		std::stringstream stream{ text };
+		return (stream >> resolution.x >> separator >> resolution.y) && separator == 'x' && resolution.x > 0 && resolution.y > 0;
+	}
+
+	bool ParseLayout(const std::string& text, TextureSampling::TexelLayout& layout)
+	{
+		if (text == "linear")
+			layout = TextureSampling::TexelLayout::Linear;
+		else if (text == "tiled")
+			layout = TextureSampling::TexelLayout::Tiled;
+		else
+			return false;
+		return true;
+	}
+
+	template<typename T>
+	bool ParseNumber(const std::string& text, T& value)
+	{
+		std::stringstream stream{ text };
+		return (stream >> value) && stream.eof();
+	}
+
+	bool ParseOptions(int argc, char* args[], Options& options)
+	{
+		for (int i{ 1 }; i < argc; ++i)
+		{
+			const std::string_view argument{ args[i] };
+			if (argument == "--verify")
+			{
+				options.verifyShadingPaths = true;
+				continue;
+			}
+			if (i + 1 == argc)
+				return false;
+
+			const std::string value{ args[++i] };
+			if (argument == "--frames")
+			{
+				if (!ParseNumber(value, options.nrFrames))
+					return false;
+			}
+			else if (argument == "--warmup")
+			{
+				if (!ParseNumber(value, options.nrWarmupFrames))
+					return false;
+			}
+			else if (argument == "--resolutions")
+			{
+				if (!ParseList(value, options.resolutions, &ParseResolution))
+					return false;
+			}
+			else if (argument == "--threads")
+			{
+				if (!ParseList(value, options.threadCounts, &ParseNumber<uint32_t>))
+					return false;
+			}
+			else if (argument == "--shading")
+			{
+				if (value == "forward")
+					options.shadingPath = SoftwareRenderer::ShadingPath::Forward;
+				else if (value == "prepass")
+					options.shadingPath = SoftwareRenderer::ShadingPath::DepthPrePass;
+				else if (value == "visibility")
+					options.shadingPath = SoftwareRenderer::ShadingPath::VisibilityBuffer;
+				else
+					return false;
+			}
+			else if (argument == "--filter")
+			{
+				if (value == "point")
+					options.samplerState.filter = SamplerState::Filter::Point;
+				else if (value == "linear")
+					options.samplerState.filter = SamplerState::Filter::Linear;
+				else if (value == "anisotropic")
+					options.samplerState.filter = SamplerState::Filter::Anisotropic;
+				else
+					return false;
+			}
+			else if (argument == "--mip")
+			{
+				if (value == "none")
+					options.samplerState.mipFilter = SamplerState::MipFilter::None;
+				else if (value == "nearest")
+					options.samplerState.mipFilter = SamplerState::MipFilter::Nearest;
+				else if (value == "linear")
+					options.samplerState.mipFilter = SamplerState::MipFilter::Linear;
+				else
+					return false;
+			}
+			else if (argument == "--address")
+			{
+				if (value == "wrap")
+					options.samplerState.addressMode = SamplerState::AddressMode::Wrap;
+				else if (value == "clamp")
+					options.samplerState.addressMode = SamplerState::AddressMode::Clamp;
+				else
+					return false;
+			}
+			else if (argument == "--layouts")
+			{
+				if (!ParseList(value, options.layouts, &ParseLayout))
+					return false;
+			}
+			else if (argument == "--motion")
+			{
+				if (value == "orbit")
+					options.motion = Motion::Orbit;
+				else if (value == "spin")
+					options.motion = Motion::Spin;
+				else
+					return false;
+			}
+			else if (argument == "--resources")
+				options.resourcePath = value;
+			else if (argument == "--csv")
+				options.csvPath = value;
+			else if (argument == "--json")
+				options.jsonPath = value;
+			else if (argument == "--trace")
+				options.tracePath = value;
+			else
+				return false;
+		}
+		return options.nrFrames > 0 && options.nrWarmupFrames >= 0;
+	}
+
+	void WriteCSV(std::ostream& output, const std::vector<Run>& runs)
+	{
+		output << "width,height,threads,layout,checksum,stage,mean_ms,p50_ms,p95_ms,p99_ms,max_ms\n";
+		for (const Run& run : runs)
+		{
+			for (int stage{}; stage < NR_STAGES; ++stage)
+			{
+				const Summary& summary{ run.stages[stage] };
+				output << run.width << ',' << run.height << ',' << run.nrThreads << ',' << GetLayoutName(run.layout) << ',' << run.checksum << ','
+					<< GetStageName(stage) << ','
+					<< summary.mean << ',' << summary.p50 << ',' << summary.p95 << ',' << summary.p99 << ',' << summary.max << '\n';
+			}
+		}
+	}
+
+	constexpr std::array<SoftwareRenderer::ShadingPath, 3> SHADING_PATHS{ SoftwareRenderer::ShadingPath::Forward,
+		SoftwareRenderer::ShadingPath::DepthPrePass, SoftwareRenderer::ShadingPath::VisibilityBuffer };
+	constexpr std::array<const char*, 3> SHADING_NAMES{ "forward", "prepass", "visibility" };
+
+	void WriteJSON(std::ostream& output, const Options& options, const std::vector<Run>& runs)
+	{
+		const char* filterNames[]{ "point", "linear", "anisotropic" };
+		const char* mipNames[]{ "none", "nearest", "linear" };
+		const char* addressNames[]{ "wrap", "clamp" };
+		const char* motionNames[]{ "orbit", "spin" };
+		const SamplerState& sampler{ options.samplerState };
+
+		output << "{\n\t\"frames\": " << options.nrFrames << ",\n\t\"warmup\": " << options.nrWarmupFrames
+			<< ",\n\t\"shading\": \"" << SHADING_NAMES[static_cast<int>(options.shadingPath)]
+			<< "\",\n\t\"filter\": \"" << filterNames[static_cast<int>(sampler.filter)]
+			<< "\",\n\t\"mip\": \"" << mipNames[static_cast<int>(sampler.mipFilter)]
+			<< "\",\n\t\"address\": \"" << addressNames[static_cast<int>(sampler.addressMode)]
+			<< "\",\n\t\"motion\": \"" << motionNames[static_cast<int>(options.motion)] << "\",\n\t\"stageTimers\": "
+			<< (ENABLE_STAGE_TIMERS ? "true" : "false") << ",\n\t\"runs\": [";
+		for (size_t i{}; i < runs.size(); ++i)
+		{
+			const Run& run{ runs[i] };
+			output << (i == 0 ? "\n" : ",\n") << "\t\t{ \"width\": " << run.width << ", \"height\": " << run.height
+				<< ", \"threads\": " << run.nrThreads << ", \"layout\": \"" << GetLayoutName(run.layout) << "\", \"checksum\": " << run.checksum << ", \"stages\": {";
+			for (int stage{}; stage < NR_STAGES; ++stage)
+			{
+				const Summary& summary{ run.stages[stage] };
+				output << (stage == 0 ? "\n" : ",\n") << "\t\t\t\"" << GetStageName(stage) << "\": { \"mean_ms\": " << summary.mean
+					<< ", \"p50_ms\": " << summary.p50 << ", \"p95_ms\": " << summary.p95 << ", \"p99_ms\": " << summary.p99
+					<< ", \"max_ms\": " << summary.max << " }";
+			}
+			output << "\n\t\t} }";
+		}
+		output << "\n\t]\n}\n";
+	}
+}
+
+int main(int argc, char* args[])
+{
+	Options options{};
+	if (!ParseOptions(argc, args, options))
+	{
+		std::cerr << "Usage: " << args[0] << " [--frames N] [--warmup N] [--resolutions 640x480,1920x1080] [--threads 1,4,0]\n"
+			<< "\t[--shading forward|prepass|visibility] [--filter point|linear|anisotropic] [--mip none|nearest|linear]\n"
+			<< "\t[--address wrap|clamp] [--layouts linear,tiled] [--motion orbit|spin]\n"
+			<< "\t[--resources DIR] [--csv FILE] [--json FILE] [--trace FILE] [--verify]\n";
+		return 1;
+	}
+	Profiler::Get().SetThreadName("Main");
+
+	//Same scene as the rasterizer mode of the app
+	const Vector3 vehiclePosition{ 0.f, 0.f, 50.f };
+	SoftwareScene scene{};
+	MeshRasterizer& mesh{ scene.meshes.emplace_back() };
+	if (!Utils::ParseOBJ(options.resourcePath + "/vehicle.obj", mesh.vertices, mesh.indices))
+	{
+		std::cerr << "Could not load " << options.resourcePath << "/vehicle.obj\n";
+		return 1;
+	}
+	mesh.primitiveTopology = PrimitiveTopology::TriangleList;
+	mesh.worldMatrix = Matrix::CreateTranslation(vehiclePosition);
+
+	const std::unique_ptr<Texture> pDiffuseTxt{ Texture::LoadFromFile(options.resourcePath + "/vehicle_diffuse.png") };
+	const std::unique_ptr<Texture> pNormalTxt{ Texture::LoadFromFile(options.resourcePath + "/vehicle_normal.png") };
+	const std::unique_ptr<Texture> pSpecularTxt{ Texture::LoadFromFile(options.resourcePath + "/vehicle_specular.png") };
+	const std::unique_ptr<Texture> pGlossTxt{ Texture::LoadFromFile(options.resourcePath + "/vehicle_gloss.png") };
+
+	std::vector<Run> runs{};
+	bool shadingPathsMatch{ true };
+	for (TextureSampling::TexelLayout layout : options.layouts)
+	{
+		const MaterialTexture material{ *pDiffuseTxt, *pNormalTxt, *pSpecularTxt, *pGlossTxt, layout };
+		scene.pMaterialTxt = &material;
+
+		for (const Int2& resolution : options.resolutions)
+		{
+			for (uint32_t nrThreads : options.threadCounts)
+			{
+				SoftwareRenderer renderer{ resolution.x, resolution.y, nrThreads };
+				renderer.GetSettings().shadingPath = options.shadingPath;
+				renderer.GetSettings().samplerState = options.samplerState;
+
+				std::vector<uint32_t> colorBuffer(size_t(resolution.x) * resolution.y);
+				SoftwareRenderTarget target{};
+				target.pColor = colorBuffer.data();
+
+				Camera camera{};
+				camera.Initialize(45.f, {}, float(resolution.x) / resolution.y);
+				camera.CalculateViewMatrix(); //spin keeps this view, orbit moves it every frame
+				camera.CalculateProjectionMatrix();
+
+				auto placeFrame = [&](int frame)
+				{
+					if (options.motion == Motion::Orbit)
+					{
+						PlaceCamera(camera, vehiclePosition, frame, options.nrFrames);
+					}
+					else
+					{
+						SpinVehicle(mesh, vehiclePosition, frame, options.nrFrames);
+					}
+				};
+
+				//Warm up on the first frame of the path, so caches and frame arenas settle before timing
+				placeFrame(0);
+				for (int frame{}; frame < options.nrWarmupFrames; ++frame)
+				{
+					renderer.Render(scene, camera, target);
+				}
+
+				std::array<std::vector<double>, NR_STAGES> stageSamples{};
+				for (std::vector<double>& samples : stageSamples)
+				{
+					samples.reserve(options.nrFrames);
+				}
+
+				for (int frame{}; frame < options.nrFrames; ++frame)
+				{
+					placeFrame(frame);
+					renderer.Render(scene, camera, target);
+
+					const std::array<double, NR_STAGES> stageTimes{ GetStageTimes(renderer) };
+					for (int stage{}; stage < NR_STAGES; ++stage)
+					{
+						stageSamples[stage].push_back(stageTimes[stage]);
+					}
+				}
+
+				Run& run{ runs.emplace_back() };
+				run.width = resolution.x;
+				run.height = resolution.y;
+				run.nrThreads = renderer.GetNrThreads();
+				run.layout = layout;
+				run.checksum = GetChecksum(colorBuffer);
+				for (int stage{}; stage < NR_STAGES; ++stage)
+				{
+					run.stages[stage] = Summarize(stageSamples[stage]);
+				}
+
+				const Summary& frame{ run.stages[0] };
+				std::cout << run.width << 'x' << run.height << ", " << run.nrThreads << " threads, " << GetLayoutName(run.layout) << ": mean "
+					<< frame.mean << " ms, p50 " << frame.p50 << " ms, p95 " << frame.p95 << " ms, p99 " << frame.p99 << " ms, max " << frame.max << " ms\n";
+
+				//Same frame, every other path: a pre-pass whose depths differ from the shading pass drops pixels without any other sign
+				if (options.verifyShadingPaths)
+				{
+					for (size_t path{}; path < SHADING_PATHS.size(); ++path)
+					{
+						if (SHADING_PATHS[path] == options.shadingPath)
+							continue;
+
+						renderer.GetSettings().shadingPath = SHADING_PATHS[path];
+						renderer.Render(scene, camera, target);
+						const uint32_t checksum{ GetChecksum(colorBuffer) };
+						if (checksum != run.checksum)
+						{
+							std::cerr << "Shading path " << SHADING_NAMES[path] << " renders checksum " << checksum << ", "
+								<< SHADING_NAMES[static_cast<int>(options.shadingPath)] << " renders " << run.checksum << '\n';
+							shadingPathsMatch = false;
+						}
+					}
+					renderer.GetSettings().shadingPath = options.shadingPath;
+				}
+			}
+		}
+	}
+
+	WriteCSV(std::cout, runs);
+	if (!options.csvPath.empty())
+	{
+		std::ofstream file{ options.csvPath };
+		WriteCSV(file, runs);
+	}
+	if (!options.jsonPath.empty())
+	{
+		std::ofstream file{ options.jsonPath };
+		WriteJSON(file, options, runs);
+	}
+	if (!options.tracePath.empty() && !Profiler::Get().WriteTrace(options.tracePath))
+	{
+		std::cerr << "Could not write " << options.tracePath << '\n';
+		return 1;
+	}
+	return shadingPathsMatch ? 0 : 1;
+}
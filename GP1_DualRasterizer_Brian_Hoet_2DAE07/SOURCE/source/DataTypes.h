@@ -14,13 +14,114 @@ struct Vertex
 struct Vertex_Out
 {
 	Vector4 position{};
-	ColorRGB color{};
 	dae::Vector2 uv{};
 	Vector3 normal{};
 	Vector3 tangent{};
 	Vector3 viewDirection{};
 };
 
+//Interpolated vertex attributes of the software rasterizer, in stream order
+enum VertexAttribute
+{
+	AttributeU,
+	AttributeV,
+	AttributeNormalX,
+	AttributeNormalY,
+	AttributeNormalZ,
+	AttributeTangentX,
+	AttributeTangentY,
+	AttributeTangentZ,
+	AttributeViewDirectionX,
+	AttributeViewDirectionY,
+	AttributeViewDirectionZ,
+	NrVertexAttributes
+};
+
+//The attributes of one vertex, a column of the transformed vertex streams or a packed clipped vertex
+struct VertexAttributes
+{
+	const float* pFirst{};
+	size_t stride{ 1 };
+
+	float operator[](int attribute) const { return pFirst[attribute * stride]; }
+};
+
+//Sub-pixel precision of the software rasterizer (28.4 fixed point)
+constexpr int SUB_PIXEL_BITS{ 4 };
+constexpr int SUB_PIXEL_SCALE{ 1 << SUB_PIXEL_BITS };
+constexpr int SUB_PIXEL_HALF{ SUB_PIXEL_SCALE / 2 };
+constexpr float MAX_SCREEN_COORDINATE{ float(1 << (22 - SUB_PIXEL_BITS)) }; //|coordinate| in pixels, keeps edge steps within 32 bits
+constexpr float GUARD_BAND_COORDINATE{ MAX_SCREEN_COORDINATE / 2 }; //|coordinate| in pixels the clipper lets through, with room for rounding
+
+//Integer edge equation E(x, y) = a * x + b * y + c on fixed point coordinates
+//A sample is inside when E >= 0, c already holds the top-left fill rule bias
+struct EdgeFunction
+{
+	int64_t a{};
+	int64_t b{};
+	int64_t c{};
+
+	//Edge from (x0, y0) to (x1, y1) of a triangle with positive area
+	static EdgeFunction Create(int64_t x0, int64_t y0, int64_t x1, int64_t y1)
+	{
+		EdgeFunction edge{ y0 - y1, x1 - x0, 0 };
+		edge.c = -(edge.a * x0 + edge.b * y0);
+
+		//Top-left rule: samples exactly on a right or bottom edge belong to the neighbour
+		const bool isTopLeft{ edge.a > 0 || (edge.a == 0 && edge.b > 0) };
+		if (!isTopLeft)
+		{
+			edge.c -= 1;
+		}
+		return edge;
+	}
+
+	int64_t Evaluate(int64_t x, int64_t y) const
+	{
+		return a * x + b * y + c;
+	}
+};
+
+//Screen space plane f(x, y) = dx * x + dy * y + c of a value that is affine on screen,
+//x and y are whole pixels relative to the triangle's (minX, minY) pixel
+struct AttributePlane
+{
+	float dx{};
+	float dy{};
+	float c{};
+};
+
+//Per triangle constants of the raster and shading passes, binned into screen tiles
+struct TriangleSetup
+{
+	//Edge opposite to A, B and C
+	EdgeFunction edgeBC{};
+	EdgeFunction edgeCA{};
+	EdgeFunction edgeAB{};
+
+	//NDC depth and 1/w, the attributes are divided by w so they are affine on screen as well
+	AttributePlane depth{};
+	AttributePlane inverseW{};
+	AttributePlane attributes[NrVertexAttributes]{};
+
+	//Vertex depth range
+	float minZ{};
+	float maxZ{};
+
+	//Pixel bounding box, max is exclusive
+	int minX{};
+	int minY{};
+	int maxX{};
+	int maxY{};
+};
+
+//Encloses every depth buffer value of one hierarchical depth cell
+struct DepthBounds
+{
+	float min{};
+	float max{};
+};
+
 enum class PrimitiveTopology
 {
 	TriangleList,
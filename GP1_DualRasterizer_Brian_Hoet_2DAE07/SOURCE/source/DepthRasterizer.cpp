@@ -0,0 +1,82 @@
+#include "pch.h"
+#include "DepthRasterizer.h"
+#include <bit>
+
+SimdFloat DepthRasterizer::GetBlockDepth(const TriangleSetup& triangle, int bx, int by)
+{
+	SimdFloat x, y;
+	GetBlockCoordinates(triangle, bx, by, x, y);
+	return EvaluatePlane(triangle.depth, x, y);
+}
+
+bool DepthRasterizer::RasterizeTriangle(const TriangleSetup& triangle, const DepthTarget& target, int minX, int minY, int maxX, int maxY)
+{
+	const SimdInt laneOffsetBC{ GetLaneOffsets(triangle.edgeBC) };
+	const SimdInt laneOffsetCA{ GetLaneOffsets(triangle.edgeCA) };
+	const SimdInt laneOffsetAB{ GetLaneOffsets(triangle.edgeAB) };
+
+	const int64_t stepXBC{ triangle.edgeBC.a * SUB_PIXEL_SCALE * SIMD_BLOCK_WIDTH };
+	const int64_t stepXCA{ triangle.edgeCA.a * SUB_PIXEL_SCALE * SIMD_BLOCK_WIDTH };
+	const int64_t stepXAB{ triangle.edgeAB.a * SUB_PIXEL_SCALE * SIMD_BLOCK_WIDTH };
+	const int64_t stepYBC{ triangle.edgeBC.b * SUB_PIXEL_SCALE * SIMD_BLOCK_HEIGHT };
+	const int64_t stepYCA{ triangle.edgeCA.b * SUB_PIXEL_SCALE * SIMD_BLOCK_HEIGHT };
+	const int64_t stepYAB{ triangle.edgeAB.b * SUB_PIXEL_SCALE * SIMD_BLOCK_HEIGHT };
+
+	//Blocks sit on the 4x2 grid of the target
+	const int blockMinX{ minX - minX % SIMD_BLOCK_WIDTH };
+	const int blockMinY{ minY - minY % SIMD_BLOCK_HEIGHT };
+
+	const int64_t startX{ int64_t(blockMinX) * SUB_PIXEL_SCALE + SUB_PIXEL_HALF };
+	const int64_t startY{ int64_t(blockMinY) * SUB_PIXEL_SCALE + SUB_PIXEL_HALF };
+	int64_t rowBC{ triangle.edgeBC.Evaluate(startX, startY) };
+	int64_t rowCA{ triangle.edgeCA.Evaluate(startX, startY) };
+	int64_t rowAB{ triangle.edgeAB.Evaluate(startX, startY) };
+
+	bool depthChanged{ false };
+
+	for (int by{ blockMinY }; by < maxY; by += SIMD_BLOCK_HEIGHT, rowBC += stepYBC, rowCA += stepYCA, rowAB += stepYAB)
+	{
+		int64_t edgeBC{ rowBC };
+		int64_t edgeCA{ rowCA };
+		int64_t edgeAB{ rowAB };
+		for (int bx{ blockMinX }; bx < maxX; bx += SIMD_BLOCK_WIDTH, edgeBC += stepXBC, edgeCA += stepXCA, edgeAB += stepXAB)
+		{
+			const int rectMask{ GetRectMask(bx, by, minX, minY, maxX, maxY) };
+			const int coverage{ rectMask & ~SignMask((ToLane(edgeBC) + laneOffsetBC) | (ToLane(edgeCA) + laneOffsetCA) | (ToLane(edgeAB) + laneOffsetAB)) };
+			if (coverage == 0)
+				continue;
+
+			const SimdFloat depth{ GetBlockDepth(triangle, bx, by) };
+
+			float* pDepthRow0{ &target.pPixels[bx + (by * target.width)] };
+			float* pDepthRow1{ pDepthRow0 + target.width };
+			if (rectMask == 0xFF)
+			{
+				const SimdFloat storedZ{ SimdFloat::LoadBlock(pDepthRow0, pDepthRow1) };
+				const int visible{ coverage & LessEqualMask(depth, storedZ) };
+				if (visible != 0)
+				{
+					Select(visible, depth, storedZ).StoreBlock(pDepthRow0, pDepthRow1);
+					depthChanged = true;
+				}
+			}
+			else
+			{
+				float depthLanes[SIMD_WIDTH];
+				depth.Store(depthLanes);
+				for (int lanes{ coverage }; lanes != 0; lanes &= lanes - 1)
+				{
+					const int lane{ std::countr_zero(unsigned(lanes)) };
+					float& storedZ{ (lane < SIMD_BLOCK_WIDTH ? pDepthRow0 : pDepthRow1)[lane & 3] };
+					if (depthLanes[lane] <= storedZ)
+					{
+						storedZ = depthLanes[lane];
+						depthChanged = true;
+					}
+				}
+			}
+		}
+	}
+
+	return depthChanged;
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include "DataTypes.h"
+#include "Simd.h"
+
+//Any float depth buffer the depth-only kernel can render into:
+//the main depth buffer for a pre-pass, a shadow map or an occlusion buffer
+struct DepthTarget
+{
+	float* pPixels{};
+	int width{};
+	int height{};
+};
+
+namespace DepthRasterizer
+{
+	//Edge value offsets of every lane relative to lane 0 of a 4x2 block
+	inline SimdInt GetLaneOffsets(const EdgeFunction& edge)
+	{
+		const int32_t x{ static_cast<int32_t>(edge.a * SUB_PIXEL_SCALE) };
+		const int32_t y{ static_cast<int32_t>(edge.b * SUB_PIXEL_SCALE) };
+		return SimdInt{ 0, x, 2 * x, 3 * x, y, y + x, y + 2 * x, y + 3 * x };
+	}
+
+	//Far away edges saturate, the lane offsets can not flip their sign
+	inline SimdInt ToLane(int64_t edgeValue)
+	{
+		constexpr int64_t laneLimit{ int64_t(1) << 30 };
+		return SimdInt{ static_cast<int32_t>(std::clamp(edgeValue, -laneLimit, laneLimit)) };
+	}
+
+	//Lanes of the 4x2 block at (bx, by) inside [minX, maxX) x [minY, maxY)
+	inline int GetRectMask(int bx, int by, int minX, int minY, int maxX, int maxY)
+	{
+		const int rowMask{ (by >= minY && by < maxY ? 0x0F : 0) | (by + 1 >= minY && by + 1 < maxY ? 0xF0 : 0) };
+
+		int columnMask{ 0xF };
+		if (bx < minX)
+		{
+			columnMask &= 0xF << (minX - bx);
+		}
+		if (bx + SIMD_BLOCK_WIDTH > maxX)
+		{
+			columnMask &= 0xF >> (bx + SIMD_BLOCK_WIDTH - maxX);
+		}
+		return rowMask & (columnMask | columnMask << 4);
+	}
+
+	//Pixel coordinates of the lanes of the 4x2 block at (bx, by), relative to the triangle's plane origin
+	inline void GetBlockCoordinates(const TriangleSetup& triangle, int bx, int by, SimdFloat& x, SimdFloat& y)
+	{
+		x = SimdFloat{ float(bx - triangle.minX) } + SimdFloat{ 0.f, 1.f, 2.f, 3.f, 0.f, 1.f, 2.f, 3.f };
+		y = SimdFloat{ float(by - triangle.minY) } + SimdFloat{ 0.f, 0.f, 0.f, 0.f, 1.f, 1.f, 1.f, 1.f };
+	}
+
+	inline SimdFloat EvaluatePlane(const AttributePlane& plane, const SimdFloat& x, const SimdFloat& y)
+	{
+		return x * plane.dx + y * plane.dy + SimdFloat{ plane.c };
+	}
+
+	//Depth of the lanes of the 4x2 block at (bx, by). Every kernel that tests depth gets it from here, out of line,
+	//so the equal test after a pre-pass compares values of the one compiled copy, whatever the compiler fuses inline
+	SimdFloat GetBlockDepth(const TriangleSetup& triangle, int bx, int by);
+
+	//Depth-only kernel, reads nothing but the triangle's edges and depth plane.
+	//Less-equal test and write for the samples in [minX, maxX) x [minY, maxY) of the target.
+	//Returns whether any depth value changed.
+	bool RasterizeTriangle(const TriangleSetup& triangle, const DepthTarget& target, int minX, int minY, int maxX, int maxY);
+}
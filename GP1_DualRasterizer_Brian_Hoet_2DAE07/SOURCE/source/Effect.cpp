@@ -62,22 +62,22 @@ void Effect::ToggleSampling()
 		switch (m_SampleMethod)
 		{
 		case SampleMethod::Point:
-			m_pTechnique = m_pEffect->GetTechniqueByName("PointFilteringTechnique");
+			m_pTechnique = m_pEffect->GetTechniqueByName("LinearFilteringTechnique");
 			m_SampleMethod = SampleMethod::Linear;
 			if (!m_pTechnique->IsValid())
-				std::cout << "PointTechnique not valid\n";
+				std::cout << "LinearTechnique not valid\n";
 			break;
 		case SampleMethod::Linear:
-			m_pTechnique = m_pEffect->GetTechniqueByName("LinearFilteringTechnique");
+			m_pTechnique = m_pEffect->GetTechniqueByName("AnisotropicFilteringTechnique");
 			m_SampleMethod = SampleMethod::Anisotropic;
 			if (!m_pTechnique->IsValid())
-				std::cout << "LinearTechnique not valid\n";
+				std::cout << "AnisotropicTechnique not valid\n";
 			break;
 		case SampleMethod::Anisotropic:
-			m_pTechnique = m_pEffect->GetTechniqueByName("AnisotropicFilteringTechnique");
+			m_pTechnique = m_pEffect->GetTechniqueByName("PointFilteringTechnique");
 			m_SampleMethod = SampleMethod::Point;
 			if (!m_pTechnique->IsValid())
-				std::cout << "AnisotropicTechnique not valid\n";
+				std::cout << "PointTechnique not valid\n";
 			break;
 		default:
 			break;
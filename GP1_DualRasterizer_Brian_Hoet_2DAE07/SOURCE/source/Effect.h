@@ -38,7 +38,7 @@ protected:
 		Linear,
 		Anisotropic
 	};
-	SampleMethod m_SampleMethod;
+	SampleMethod m_SampleMethod{ SampleMethod::Point }; //the technique in use
 
 	enum class CullMode
 	{
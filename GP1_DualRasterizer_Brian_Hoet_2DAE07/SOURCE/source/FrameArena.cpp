@@ -0,0 +1,78 @@
+#include "pch.h"
+#include "FrameArena.h"
+
+#if defined(DEBUG) || defined(_DEBUG)
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#endif
+
+void FrameArena::Reset()
+{
+	//Last frame did not fit, grow with some headroom so small fluctuations do not allocate again
+	if (!m_OverflowBlocks.empty())
+	{
+		m_OverflowBlocks.clear();
+		m_Capacity = m_Used + m_Used / 2;
+		m_pBlock = std::make_unique_for_overwrite<std::byte[]>(m_Capacity);
+	}
+	m_Used = 0;
+}
+
+void* FrameArena::Allocate(size_t size, size_t alignment)
+{
+	const size_t offset{ (m_Used + alignment - 1) / alignment * alignment };
+	m_Used = offset + size;
+	if (m_Used <= m_Capacity)
+		return m_pBlock.get() + offset;
+
+	return m_OverflowBlocks.emplace_back(std::make_unique_for_overwrite<std::byte[]>(size)).get();
+}
+
+#if defined(DEBUG) || defined(_DEBUG)
+static std::atomic<size_t> g_NrHeapAllocations{};
+
+size_t GetHeapAllocationCount()
+{
+	return g_NrHeapAllocations.load(std::memory_order_relaxed);
+}
+
+//Counting replacements of the global allocation functions, the array and sized forms forward to these
+void* operator new(size_t size)
+{
+	g_NrHeapAllocations.fetch_add(1, std::memory_order_relaxed);
+	if (void* pMemory{ std::malloc(size != 0 ? size : 1) })
+		return pMemory;
+
+	throw std::bad_alloc{};
+}
+
+void operator delete(void* pMemory) noexcept
+{
+	std::free(pMemory);
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+	g_NrHeapAllocations.fetch_add(1, std::memory_order_relaxed);
+	const size_t alignmentBytes{ static_cast<size_t>(alignment) };
+#if defined(_WIN32)
+	void* pMemory{ _aligned_malloc(size != 0 ? size : 1, alignmentBytes) };
+#else
+	void* pMemory{ std::aligned_alloc(alignmentBytes, (std::max<size_t>(size, 1) + alignmentBytes - 1) / alignmentBytes * alignmentBytes) };
+#endif
+	if (pMemory)
+		return pMemory;
+
+	throw std::bad_alloc{};
+}
+
+void operator delete(void* pMemory, std::align_val_t) noexcept
+{
+#if defined(_WIN32)
+	_aligned_free(pMemory);
+#else
+	std::free(pMemory);
+#endif
+}
+#endif
@@ -0,0 +1,49 @@
+#pragma once
+
+//Standard includes
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+//Transient memory for one frame of the software pipeline: allocations only bump an offset
+//and everything is released at once by Reset. A frame that needs more than the block
+//is served from overflow blocks, the next Reset grows the block so the following frames fit again.
+//Each binning job owns one, so there is no locking.
+class alignas(64) FrameArena final
+{
+public:
+	FrameArena() = default;
+	~FrameArena() = default;
+
+	FrameArena(const FrameArena&) = delete;
+	FrameArena(FrameArena&&) noexcept = default;
+	FrameArena& operator=(const FrameArena&) = delete;
+	FrameArena& operator=(FrameArena&&) noexcept = default;
+
+	//Uninitialized storage for count objects, valid until the next Reset
+	template<typename T>
+	T* Allocate(size_t count)
+	{
+		static_assert(std::is_trivially_destructible_v<T>, "FrameArena never runs destructors");
+		static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__, "FrameArena blocks use the default new alignment");
+		return static_cast<T*>(Allocate(count * sizeof(T), alignof(T)));
+	}
+
+	void Reset();
+	size_t GetCapacity() const { return m_Capacity; }
+	bool HasOverflowed() const { return !m_OverflowBlocks.empty(); } //this frame allocated, the next Reset grows
+
+private:
+	void* Allocate(size_t size, size_t alignment);
+
+	std::unique_ptr<std::byte[]> m_pBlock{};
+	size_t m_Capacity{};
+	size_t m_Used{}; //bytes asked for this frame, overflow included
+	std::vector<std::unique_ptr<std::byte[]>> m_OverflowBlocks{};
+};
+
+#if defined(DEBUG) || defined(_DEBUG)
+//Number of global operator new calls since startup, the renderer asserts it stays put in steady state frames
+size_t GetHeapAllocationCount();
+#endif
@@ -0,0 +1,140 @@
+#include "pch.h"
+#include "MaterialTexture.h"
+#include "Texture.h"
+#include "Profiler.h"
+#include <assert.h>
+#include <bit>
+
+namespace
+{
+	constexpr int GLOSS_SHIFT{ 24 };
+	constexpr int SPECULAR_SHIFT{ 24 };
+	constexpr uint32_t RGB_MASK{ 0xFFu << Texture::RED_SHIFT | 0xFFu << Texture::GREEN_SHIFT | 0xFFu << Texture::BLUE_SHIFT };
+
+	//The specular maps are close to grey, the tint is at most a few percent
+	uint32_t GetGrey(uint32_t texel)
+	{
+		const uint32_t sum{ ((texel >> Texture::RED_SHIFT) & 0xFF) + ((texel >> Texture::GREEN_SHIFT) & 0xFF) + ((texel >> Texture::BLUE_SHIFT) & 0xFF) };
+		return (sum + 1) / 3;
+	}
+}
+
+MaterialTexture::MaterialTexture(const Texture& diffuseMap, const Texture& normalMap, const Texture& specularMap, const Texture& glossMap,
+	TextureSampling::TexelLayout layout)
+{
+	PROFILE_ZONE("MaterialTexture::Bake");
+	const int width{ diffuseMap.GetWidth() };
+	const int height{ diffuseMap.GetHeight() };
+	assert(normalMap.GetWidth() == width && normalMap.GetHeight() == height && "The normal map is not the size of the diffuse map");
+	assert(specularMap.GetWidth() == width && specularMap.GetHeight() == height && "The specular map is not the size of the diffuse map");
+	assert(glossMap.GetWidth() == width && glossMap.GetHeight() == height && "The gloss map is not the size of the diffuse map");
+
+	//Same size, same mip chain: every level of the maps' own (box filtered) chain is baked, in the layout asked for
+	const std::vector<TextureSampling::MipLevel> mapLevels{ TextureSampling::CreateMipChain(width, height) };
+	m_MipLevels = TextureSampling::CreateMipChain(width, height, layout);
+	m_Texels.resize(TextureSampling::GetNrTexels(m_MipLevels));
+
+	const std::vector<uint32_t>& diffuseTexels{ diffuseMap.GetTexels() };
+	const std::vector<uint32_t>& normalTexels{ normalMap.GetTexels() };
+	const std::vector<uint32_t>& specularTexels{ specularMap.GetTexels() };
+	const std::vector<uint32_t>& glossTexels{ glossMap.GetTexels() };
+	for (size_t levelIndex{}; levelIndex < m_MipLevels.size(); ++levelIndex)
+	{
+		const TextureSampling::MipLevel& mapLevel{ mapLevels[levelIndex] };
+		const TextureSampling::MipLevel& level{ m_MipLevels[levelIndex] };
+		for (int y{}; y < level.height; ++y)
+		{
+			for (int x{}; x < level.width; ++x)
+			{
+				const uint32_t mapTexel{ TextureSampling::GetTexelIndex(mapLevel, x, y) };
+				Texel& texel{ m_Texels[TextureSampling::GetTexelIndex(level, x, y)] };
+
+				//The gloss map is greyscale, red is enough
+				const uint32_t gloss{ (glossTexels[mapTexel] >> Texture::RED_SHIFT) & 0xFF };
+				texel.albedoGloss = (diffuseTexels[mapTexel] & RGB_MASK) | gloss << GLOSS_SHIFT;
+				texel.normalSpecular = (normalTexels[mapTexel] & RGB_MASK) | GetGrey(specularTexels[mapTexel]) << SPECULAR_SHIFT;
+			}
+		}
+	}
+}
+
+void MaterialTexture::SampleBlock(const SimdFloat& u, const SimdFloat& v, const TextureSampling::QuadGradients* pQuadGradients, int visible,
+	const SamplerState& sampler, const Scales& scales, Block& block) const
+{
+	const SimdFloat zero{ 0.f };
+	for (int channel{}; channel < 3; ++channel)
+	{
+		block.albedo[channel] = zero;
+		block.normal[channel] = zero;
+	}
+	block.specular = zero;
+	block.gloss = zero;
+
+	const bool isBilinear{ sampler.filter != SamplerState::Filter::Point };
+	TextureSampling::SampleFootprints(u, v, pQuadGradients, sampler, m_MipLevels,
+		[&](const SimdFloat& tapU, const SimdFloat& tapV, const TextureSampling::MipLevel* const* pQuadLevels, const SimdFloat& weight)
+		{
+			AddLevelBlock(tapU, tapV, pQuadLevels, isBilinear, sampler.addressMode, visible, weight, block);
+		});
+
+	//The constant factors ride along with the multiply that turns the stored bytes into [0, 1], normals go [0, 255] -> [-1, 1]
+	const SimdFloat albedoScale{ scales.albedo / 255.f };
+	const SimdFloat normalScale{ 2.f / 255.f };
+	const SimdFloat one{ 1.f };
+	for (int channel{}; channel < 3; ++channel)
+	{
+		block.albedo[channel] = block.albedo[channel] * albedoScale;
+		block.normal[channel] = block.normal[channel] * normalScale - one;
+	}
+	block.specular = block.specular * (scales.specular / 255.f);
+	block.gloss = block.gloss * (scales.gloss / 255.f);
+}
+
+void MaterialTexture::AddLevelBlock(const SimdFloat& u, const SimdFloat& v, const TextureSampling::MipLevel* const* pQuadLevels, bool isBilinear,
+	SamplerState::AddressMode addressMode, int visible, const SimdFloat& weight, Block& sum) const
+{
+	TextureSampling::TapTexels tapTexels;
+	TextureSampling::GetTapTexels(u, v, pQuadLevels, isBilinear, addressMode, tapTexels);
+
+	//One 8 byte load per texel for the whole material
+	const int nrTexels{ isBilinear ? 4 : 1 };
+	uint32_t albedoGlossLanes[4][SIMD_WIDTH]{};
+	uint32_t normalSpecularLanes[4][SIMD_WIDTH]{};
+	for (int lanes{ visible }; lanes != 0; lanes &= lanes - 1)
+	{
+		const int lane{ std::countr_zero(unsigned(lanes)) };
+		for (int texel{}; texel < nrTexels; ++texel)
+		{
+			const Texel& materialTexel{ m_Texels[tapTexels.indices[texel][lane]] };
+			albedoGlossLanes[texel][lane] = materialTexel.albedoGloss;
+			normalSpecularLanes[texel][lane] = materialTexel.normalSpecular;
+		}
+	}
+
+	//albedo RGB, gloss, normal XYZ, specular
+	constexpr int NR_CHANNELS{ 8 };
+	const SimdInt byteMask{ 0xFF };
+	SimdFloat channels[NR_CHANNELS][4];
+	for (int texel{}; texel < nrTexels; ++texel)
+	{
+		const SimdInt albedoGloss{ SimdInt::Load(albedoGlossLanes[texel]) };
+		channels[0][texel] = ToFloat(ShiftRight(albedoGloss, Texture::RED_SHIFT) & byteMask);
+		channels[1][texel] = ToFloat(ShiftRight(albedoGloss, Texture::GREEN_SHIFT) & byteMask);
+		channels[2][texel] = ToFloat(ShiftRight(albedoGloss, Texture::BLUE_SHIFT) & byteMask);
+		channels[3][texel] = ToFloat(ShiftRight(albedoGloss, GLOSS_SHIFT));
+
+		const SimdInt normalSpecular{ SimdInt::Load(normalSpecularLanes[texel]) };
+		channels[4][texel] = ToFloat(ShiftRight(normalSpecular, Texture::RED_SHIFT) & byteMask);
+		channels[5][texel] = ToFloat(ShiftRight(normalSpecular, Texture::GREEN_SHIFT) & byteMask);
+		channels[6][texel] = ToFloat(ShiftRight(normalSpecular, Texture::BLUE_SHIFT) & byteMask);
+		channels[7][texel] = ToFloat(ShiftRight(normalSpecular, SPECULAR_SHIFT));
+	}
+
+	SimdFloat* pSums[NR_CHANNELS]{ &sum.albedo[0], &sum.albedo[1], &sum.albedo[2], &sum.gloss,
+		&sum.normal[0], &sum.normal[1], &sum.normal[2], &sum.specular };
+	for (int channel{}; channel < NR_CHANNELS; ++channel)
+	{
+		const SimdFloat value{ isBilinear ? TextureSampling::Bilinear(channels[channel], tapTexels) : channels[channel][0] };
+		*pSums[channel] = *pSums[channel] + value * weight;
+	}
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include "TextureSampling.h"
+
+//Standard includes
+#include <vector>
+
+class Texture;
+
+//The diffuse, normal, specular and gloss maps of a material baked into one stream of 8 byte texels,
+//so a tap reads one texel instead of one from every map
+class MaterialTexture final
+{
+public:
+	//The maps must all be the same size
+	MaterialTexture(const Texture& diffuseMap, const Texture& normalMap, const Texture& specularMap, const Texture& glossMap,
+		TextureSampling::TexelLayout layout = TextureSampling::TexelLayout::Tiled);
+	~MaterialTexture() = default;
+
+	MaterialTexture(const MaterialTexture&) = delete;
+	MaterialTexture(MaterialTexture&&) noexcept = delete;
+	MaterialTexture& operator=(const MaterialTexture&) = delete;
+	MaterialTexture& operator=(MaterialTexture&&) noexcept = delete;
+
+	//Constant factors folded into decoding the texels, e.g. the light intensity over pi for the albedo
+	struct Scales
+	{
+		float albedo{ 1.f };
+		float specular{ 1.f };
+		float gloss{ 1.f };
+	};
+
+	//The filtered material of the 8 lanes of a 4x2 block, multiplied by the scales
+	struct Block
+	{
+		SimdFloat albedo[3];
+		SimdFloat normal[3]; //tangent space in [-1, 1], not normalized, the same as the DirectX shader gets
+		SimdFloat specular;
+		SimdFloat gloss;
+	};
+
+	//All 8 lanes of a 4x2 block at once, each of the two 2x2 quads selects its own mip levels from its gradients.
+	//Only the visible lanes are fetched
+	void SampleBlock(const SimdFloat& u, const SimdFloat& v, const TextureSampling::QuadGradients* pQuadGradients, int visible,
+		const SamplerState& sampler, const Scales& scales, Block& block) const;
+
+private:
+	struct Texel
+	{
+		uint32_t albedoGloss; //albedo RGB from the lowest byte up, gloss in the highest byte
+		uint32_t normalSpecular; //normal map RGB from the lowest byte up, greyscale specular in the highest byte
+	};
+
+	//Adds one point or bilinear tap per lane times its weight, the channels are not scaled yet
+	void AddLevelBlock(const SimdFloat& u, const SimdFloat& v, const TextureSampling::MipLevel* const* pQuadLevels, bool isBilinear,
+		SamplerState::AddressMode addressMode, int visible, const SimdFloat& weight, Block& sum) const;
+
+	//The mip levels of the maps themselves, baked texel by texel
+	std::vector<TextureSampling::MipLevel> m_MipLevels{};
+	std::vector<Texel> m_Texels{};
+};
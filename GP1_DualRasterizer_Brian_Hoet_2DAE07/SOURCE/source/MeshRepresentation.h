@@ -2,16 +2,6 @@
 #include "DataTypes.h"
 #include "Effect.h"
 
-struct MeshRasterizer
-{
-	std::vector<Vertex> vertices{};
-	std::vector<uint32_t> indices{};
-	PrimitiveTopology primitiveTopology{ PrimitiveTopology::TriangleStrip };
-
-	std::vector<Vertex_Out> vertices_out{};
-	Matrix worldMatrix{};
-};
-
 
 class MeshRepresentation final
 {
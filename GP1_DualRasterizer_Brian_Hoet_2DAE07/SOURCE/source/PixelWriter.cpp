@@ -0,0 +1,12 @@
+#include "pch.h"
+#include "PixelWriter.h"
+#include <cassert>
+
+dae::PixelWriter::PixelWriter(const SDL_PixelFormat* pFormat) :
+	m_RedShift{ pFormat->Rshift },
+	m_GreenShift{ pFormat->Gshift },
+	m_BlueShift{ pFormat->Bshift },
+	m_AlphaMask{ pFormat->Amask }
+{
+	assert(pFormat->BytesPerPixel == 4 && pFormat->Rloss == 0 && pFormat->Gloss == 0 && pFormat->Bloss == 0 && "PixelWriter only packs 8 bit channels into 32 bit pixels");
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include "ColorRGB.h"
+#include "Simd.h"
+
+//Standard includes
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+
+struct SDL_PixelFormat;
+
+namespace dae
+{
+	//Converts float colors to the packed 32 bit pixels of the back buffer.
+	//The channel shifts are read from the surface format once, instead of a SDL_MapRGB call per pixel.
+	class PixelWriter final
+	{
+	public:
+		PixelWriter() = default;
+		explicit PixelWriter(const SDL_PixelFormat* pFormat);
+		PixelWriter(int redShift, int greenShift, int blueShift, uint32_t alphaMask) :
+			m_RedShift{ redShift },
+			m_GreenShift{ greenShift },
+			m_BlueShift{ blueShift },
+			m_AlphaMask{ alphaMask }
+		{
+		}
+
+		//Bytes R, G, B, A in memory on a little endian machine, alpha opaque
+		static PixelWriter CreateRGBA8() { return PixelWriter{ 0, 8, 16, 0xFF000000 }; }
+
+		//Colors are scaled like ColorRGB::MaxToOne, then every channel is truncated to 8 bits
+		uint32_t Pack(ColorRGB color) const
+		{
+			color.MaxToOne();
+			return (uint32_t(ToChannel(color.r)) << m_RedShift) | (uint32_t(ToChannel(color.g)) << m_GreenShift) | (uint32_t(ToChannel(color.b)) << m_BlueShift) | m_AlphaMask;
+		}
+
+		//Same conversion for a 4x2 block, only the lanes in mask are written.
+		//pPixels points at lane 0, pitch is the row length in pixels.
+		void WriteBlock(uint32_t* pPixels, int pitch, int mask, SimdFloat red, SimdFloat green, SimdFloat blue) const
+		{
+			const SimdFloat one{ 1.f };
+			const SimdFloat maxValue{ Max(red, Max(green, blue)) };
+			const int tooBright{ ~LessEqualMask(maxValue, one) & 0xFF };
+			if (tooBright != 0)
+			{
+				red = Select(tooBright, red / maxValue, red);
+				green = Select(tooBright, green / maxValue, green);
+				blue = Select(tooBright, blue / maxValue, blue);
+			}
+
+			const SimdInt pixels{ ShiftLeft(ToChannel(red), m_RedShift) | ShiftLeft(ToChannel(green), m_GreenShift) | ShiftLeft(ToChannel(blue), m_BlueShift) | SimdInt{ int32_t(m_AlphaMask) } };
+
+			//Full blocks are always inside the surface, partial ones may hang over its edge
+			if (mask == 0xFF)
+			{
+				pixels.StoreBlock(pPixels, pPixels + pitch);
+				return;
+			}
+
+			uint32_t pixelLanes[SIMD_WIDTH];
+			pixels.Store(pixelLanes);
+			for (int lanes{ mask }; lanes != 0; lanes &= lanes - 1)
+			{
+				const int lane{ std::countr_zero(unsigned(lanes)) };
+				pPixels[(lane & 3) + (lane >> 2) * pitch] = pixelLanes[lane];
+			}
+		}
+
+	private:
+		static uint8_t ToChannel(float value) { return static_cast<uint8_t>(std::max(value, 0.f) * 255); }
+		static SimdInt ToChannel(const SimdFloat& value) { return TruncateToInt(Max(value, SimdFloat{ 0.f }) * 255.f); }
+
+		int m_RedShift{ 16 };
+		int m_GreenShift{ 8 };
+		int m_BlueShift{ 0 };
+		uint32_t m_AlphaMask{};
+	};
+}
@@ -0,0 +1,68 @@
+#include "pch.h"
+#include "Profiler.h"
+
+//Standard includes
+#include <fstream>
+
+Profiler& Profiler::Get()
+{
+	static Profiler profiler{};
+	return profiler;
+}
+
+Profiler::Profiler() :
+	m_StartTime{ std::chrono::steady_clock::now() }
+{
+}
+
+void Profiler::SetThreadName(const std::string& name)
+{
+	ThreadBuffer& buffer{ GetThreadBuffer() };
+	std::lock_guard lock{ m_Mutex };
+	buffer.threadName = name;
+}
+
+bool Profiler::WriteTrace(const std::string& path) const
+{
+	std::ofstream file{ path };
+	if (!file)
+		return false;
+
+	auto toMicroseconds = [this](std::chrono::steady_clock::time_point time)
+	{
+		return std::chrono::duration<double, std::micro>(time - m_StartTime).count();
+	};
+
+	//Complete events ("X") carry their own duration, so nesting needs no matching begin and end
+	file << std::fixed;
+	file.precision(3);
+	file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+	std::lock_guard lock{ m_Mutex };
+	bool isFirst{ true };
+	for (const std::unique_ptr<ThreadBuffer>& pBuffer : m_ThreadBuffers)
+	{
+		file << (isFirst ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << pBuffer->threadId
+			<< ",\"args\":{\"name\":\"" << pBuffer->threadName << "\"}}";
+		isFirst = false;
+
+		//Oldest first, once the ring is full that is the one the next zone overwrites
+		const uint64_t first{ pBuffer->nrRecorded > ThreadBuffer::Capacity ? pBuffer->nrRecorded - ThreadBuffer::Capacity : 0 };
+		for (uint64_t index{ first }; index < pBuffer->nrRecorded; ++index)
+		{
+			const Event& event{ pBuffer->events[index % ThreadBuffer::Capacity] };
+			file << ",\n{\"name\":\"" << event.pName << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << pBuffer->threadId
+				<< ",\"ts\":" << toMicroseconds(event.start) << ",\"dur\":" << toMicroseconds(event.end) - toMicroseconds(event.start) << '}';
+		}
+	}
+
+	file << "\n]}\n";
+	return file.good();
+}
+
+Profiler::ThreadBuffer* Profiler::AddThreadBuffer()
+{
+	std::lock_guard lock{ m_Mutex };
+	const uint32_t threadId{ static_cast<uint32_t>(m_ThreadBuffers.size()) };
+	return m_ThreadBuffers.emplace_back(std::make_unique<ThreadBuffer>(threadId)).get();
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+//Standard includes
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+//Define as 0 to compile every PROFILE_ZONE out
+#if !defined(ENABLE_PROFILER)
+#define ENABLE_PROFILER 1
+#endif
+
+//Records named zones with their thread, written out as a Chrome trace (chrome://tracing or ui.perfetto.dev).
+//Every thread records into its own ring buffer, so a zone takes no locks, only the oldest zones get overwritten.
+class Profiler final
+{
+public:
+	static Profiler& Get();
+
+	~Profiler() = default;
+
+	Profiler(const Profiler&) = delete;
+	Profiler(Profiler&&) noexcept = delete;
+	Profiler& operator=(const Profiler&) = delete;
+	Profiler& operator=(Profiler&&) noexcept = delete;
+
+	//Name of the calling thread in the trace, also allocates its ring buffer up front
+	void SetThreadName(const std::string& name);
+	//Only call while no other thread is recording zones, e.g. between frames
+	bool WriteTrace(const std::string& path) const;
+
+	class Zone final
+	{
+	public:
+		explicit Zone(const char* pName) : //must outlive the profiler, a string literal
+			m_pName{ pName },
+			m_Start{ std::chrono::steady_clock::now() }
+		{
+		}
+
+		~Zone()
+		{
+			Get().GetThreadBuffer().Record(m_pName, m_Start, std::chrono::steady_clock::now());
+		}
+
+		Zone(const Zone&) = delete;
+		Zone(Zone&&) noexcept = delete;
+		Zone& operator=(const Zone&) = delete;
+		Zone& operator=(Zone&&) noexcept = delete;
+
+	private:
+		const char* m_pName;
+		std::chrono::steady_clock::time_point m_Start;
+	};
+
+private:
+	Profiler();
+
+	struct Event
+	{
+		const char* pName;
+		std::chrono::steady_clock::time_point start;
+		std::chrono::steady_clock::time_point end;
+	};
+
+	struct alignas(64) ThreadBuffer
+	{
+		static constexpr size_t Capacity{ 1 << 15 };
+
+		explicit ThreadBuffer(uint32_t id) :
+			events(Capacity),
+			threadId{ id },
+			threadName{ "Thread " + std::to_string(id) }
+		{
+		}
+
+		void Record(const char* pName, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)
+		{
+			events[nrRecorded % Capacity] = Event{ pName, start, end };
+			++nrRecorded;
+		}
+
+		std::vector<Event> events;
+		uint64_t nrRecorded{};
+		uint32_t threadId;
+		std::string threadName;
+	};
+
+	ThreadBuffer& GetThreadBuffer()
+	{
+		if (m_pThreadBuffer == nullptr)
+		{
+			m_pThreadBuffer = AddThreadBuffer();
+		}
+		return *m_pThreadBuffer;
+	}
+	ThreadBuffer* AddThreadBuffer();
+
+	//Owned here, so the zones of threads that already ended still make it into the trace
+	std::vector<std::unique_ptr<ThreadBuffer>> m_ThreadBuffers{};
+	mutable std::mutex m_Mutex{};
+	std::chrono::steady_clock::time_point m_StartTime;
+
+	static inline thread_local ThreadBuffer* m_pThreadBuffer{ nullptr };
+};
+
+#if ENABLE_PROFILER
+#define PROFILE_ZONE(name) const Profiler::Zone profileZone{ name }
+#else
+#define PROFILE_ZONE(name)
+#endif
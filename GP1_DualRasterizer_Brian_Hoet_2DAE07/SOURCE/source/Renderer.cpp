@@ -2,8 +2,10 @@
 #include "Renderer.h"
 #include "MeshRepresentation.h"
 #include "Texture.h"
+#include "MaterialTexture.h"
 #include "ShadedEffect.h"
 #include "Utils.h"
+#include "Profiler.h"
 
 HANDLE m_hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
 
@@ -57,15 +59,17 @@ Renderer::Renderer(SDL_Window* pWindow) :
 	//Create Buffers
 	m_pFrontBuffer = SDL_GetWindowSurface(pWindow);
 	m_pBackBuffer = SDL_CreateRGBSurface(0, m_Width, m_Height, 32, 0, 0, 0, 0);
-	m_pBackBufferPixels = (uint32_t*)m_pBackBuffer->pixels;
 
-	m_pDepthBufferPixels = new float[m_Width * m_Height];
+	m_pSoftwareRenderer = std::make_unique<SoftwareRenderer>(m_Width, m_Height);
 
-	//Mesh
-	MeshRasterizer& mesh = m_pMeshesRast.emplace_back(MeshRasterizer{});
+	//Scene, bakes the textures of the DirectX effect into one material
+	MeshRasterizer& mesh = m_SoftwareScene.meshes.emplace_back(MeshRasterizer{});
 	Utils::ParseOBJ("Resources/vehicle.obj", mesh.vertices, mesh.indices);
 	mesh.primitiveTopology = PrimitiveTopology::TriangleList;
 
+	m_pMaterialTxt = new MaterialTexture(*m_pDiffuseTxt, *m_pNormalTxt, *m_pSpecularTxt, *m_pGlossTxt);
+	m_SoftwareScene.pMaterialTxt = m_pMaterialTxt;
+
 	PrintText();
 }
 
@@ -95,7 +99,8 @@ Renderer::~Renderer()
 	delete m_pNormalTxt;
 	delete m_pSpecularTxt;
 	delete m_pGlossTxt;
-	delete[] m_pDepthBufferPixels;
+	delete m_pMaterialTxt;
+	SDL_FreeSurface(m_pBackBuffer);
 }
 
 HRESULT Renderer::InitializeDirectX()
@@ -210,14 +215,15 @@ void Renderer::PrintText() const
 		cout << "[Key bindings - SHARED]\n";
 		cout << "	[F1]  Toggle Rasterizer Mode (HARDWARE/SOFTWARE)\n";
 		cout << "	[F2]  Toggle Vehicle Rotation (ON/OFF)\n";
-		cout << "	[F9]  Cycle CullMode (BACK/FRONT/NONE)\n";
+		cout << "	[F4]  Cycle Sample State (POINT/LINEAR/ANISOTROPIC)\n";
+		cout << "	[F9]  Cycle CullMode (BACK/NONE/FRONT)\n";
 		cout << "	[F10] Toggle Uniform ClearColor (ON/OFF)\n";
 		cout << "	[F11] Toggle Print FPS (ON/OFF)\n";
+		cout << "	[C]   Write Profiler Trace (Trace.json)\n";
 		cout << '\n';
 		SetConsoleTextAttribute(m_hConsole, m_Green);
 		cout << "[Key bindings - HARDWARE]\n";
 		cout << "	[F3]  Toggle FireMesh (ON/OFF)\n";
-		cout << "	[F4]  Cycle Sample State (POINT/LINEAR/ANISOTROPIC)\n";
 		cout << '\n';
 		//cout << MAGENTA;
 		SetConsoleTextAttribute(m_hConsole, m_Magenta);
@@ -226,6 +232,11 @@ void Renderer::PrintText() const
 		cout << "	[F6]  Toggle NormalMap (ON/OFF)\n";
 		cout << "	[F7]  Toggle DepthBuffer Visualization (ON/OFF)\n";
 		cout << "	[F8]  Toggle BoundingBox Visualization (ON/OFF)\n";
+		cout << "	[M]   Cycle Mip Filter (LINEAR/NONE/NEAREST)\n";
+		cout << "	[U]   Toggle Texture Address Mode (WRAP/CLAMP)\n";
+		cout << "	[O]   Toggle Overdraw Visualization (ON/OFF)\n";
+		cout << "	[P]   Cycle Shading Path (FORWARD/DEPTH_PREPASS/VISIBILITY_BUFFER)\n";
+		cout << "	[T]   Toggle Print Stage Times and Raster Stats, together with the FPS (ON/OFF)\n";
 		cout << '\n';
 		//cout << RED;
 		SetConsoleTextAttribute(m_hConsole, m_Red);
@@ -236,6 +247,7 @@ void Renderer::PrintText() const
 
 void Renderer::Update(const Timer* pTimer)
 {
+	PROFILE_ZONE("Renderer::Update");
 	m_Camera.Update(pTimer);
 
 	
@@ -265,7 +277,7 @@ void Renderer::UpdateDirectX(const Timer* pTimer)
 }
 void Renderer::UpdateRasterizer(const Timer* pTimer)
 {
-	for (MeshRasterizer& mesh : m_pMeshesRast)
+	for (MeshRasterizer& mesh : m_SoftwareScene.meshes)
 	{
 		Matrix newTrsMatrix = Matrix::CreateRotationY(m_Angle) * Matrix::CreateTranslation(Pos);
 		mesh.worldMatrix = newTrsMatrix;
@@ -274,6 +286,7 @@ void Renderer::UpdateRasterizer(const Timer* pTimer)
 
 void Renderer::Render()
 {
+	PROFILE_ZONE("Renderer::Render");
 	if (m_DirectXMode)
 	{
 		RenderDirectX();
@@ -317,207 +330,38 @@ void Renderer::RenderDirectX() const
 }
 void Renderer::RenderRasterizer()
 {
-	SDL_LockSurface(m_pBackBuffer);
-	ColorRGB clearColor{};
-	//Clear backBuffer
+	SoftwareRenderer::Settings& settings{ m_pSoftwareRenderer->GetSettings() };
 	if (!m_UniformBackGround)
 	{
-		clearColor = { .39f, .39f, .39f };
+		settings.clearColor = { .39f, .39f, .39f };
 	}
 	else
 	{
-		clearColor = { .1f, .1f, .1f };
+		settings.clearColor = { .1f, .1f, .1f };
 	}
-	clearColor *= 255;
-	uint32_t hexColor = 0xFF000000 | (uint32_t)clearColor.b << 8 | (uint32_t)clearColor.g << 16 | (uint32_t)clearColor.r;
-	SDL_FillRect(m_pBackBuffer, NULL, hexColor);
 
-	std::fill_n(m_pDepthBufferPixels, m_Width * m_Height, FLT_MAX);
-	VertexTransformationFunctionW4(m_pMeshesRast);
+	//The software renderer draws straight into the back buffer surface
+	SDL_LockSurface(m_pBackBuffer);
+	m_pSoftwareRenderer->Render(m_SoftwareScene, m_Camera, SoftwareRenderTarget{ static_cast<uint32_t*>(m_pBackBuffer->pixels), PixelWriter{ m_pBackBuffer->format } });
+	SDL_UnlockSurface(m_pBackBuffer);
 
-	for (const auto& mesh : m_pMeshesRast)
+	StageTimers& stageTimers{ m_pSoftwareRenderer->GetStageTimers() };
 	{
-		int incrementAmount{ 1 };
-		if (mesh.primitiveTopology == PrimitiveTopology::TriangleList)
-		{
-			incrementAmount = 3;
-		}
-
-		for (int i{}; i < mesh.indices.size() - 2; i += incrementAmount)
-		{
-			//Points of the Triangle
-			const uint32_t indexA{ mesh.indices[i] };
-			uint32_t indexB{ mesh.indices[i + 1] };
-			uint32_t indexC{ mesh.indices[i + 2] };
-
-			if (mesh.primitiveTopology == PrimitiveTopology::TriangleStrip)
-			{
-				if (i % 2 != 0)
-				{
-					std::swap(indexB, indexC);
-				}
-
-				if (indexA == indexB)
-					continue;
-
-				if (indexB == indexC)
-					continue;
-
-				if (indexC == indexA)
-					continue;
-			}
-
-			Vertex_Out A{ mesh.vertices_out[indexA] };
-			Vertex_Out B{ mesh.vertices_out[indexB] };
-			Vertex_Out C{ mesh.vertices_out[indexC] };
-
-			// Do frustum culling
-			if ((A.position.x < -1.0f || A.position.x > 1.0f) &&
-				(B.position.x < -1.0f || B.position.x > 1.0f) &&
-				(C.position.x < -1.0f || C.position.x > 1.0f))
-				continue;
-
-			if ((A.position.y < -1.0f || A.position.y > 1.0f) &&
-				(B.position.y < -1.0f || B.position.y > 1.0f) &&
-				(C.position.y < -1.0f || C.position.y > 1.0f))
-				continue;
-
-			if (A.position.z < 0.0f || A.position.z > 1.0f ||
-				B.position.z < 0.0f || B.position.z > 1.0f ||
-				C.position.z < 0.0f || C.position.z > 1.0f)
-				continue;
-
-			// Convert from NDC to ScreenSpace
-			A.position.x = (A.position.x + 1) / 2.0f * m_Width;
-			A.position.y = (1 - A.position.y) / 2.0f * m_Height;
-			B.position.x = (B.position.x + 1) / 2.0f * m_Width;
-			B.position.y = (1 - B.position.y) / 2.0f * m_Height;
-			C.position.x = (C.position.x + 1) / 2.0f * m_Width;
-			C.position.y = (1 - C.position.y) / 2.0f * m_Height;
-
-			float topLeftX = std::min(A.position.x, std::min(B.position.x, C.position.x));
-			float topLeftY = std::max(A.position.y, std::max(B.position.y, C.position.y));
-			float bottomRightX = std::max(A.position.x, std::max(B.position.x, C.position.x));
-			float bottomRightY = std::min(A.position.y, std::min(B.position.y, C.position.y));
-
-			topLeftX = Clamp(topLeftX, 0.f, float(m_Width));
-			topLeftY = Clamp(topLeftY, 0.f, float(m_Height));
-			bottomRightX = Clamp(bottomRightX, 0.f, float(m_Width));
-			bottomRightY = Clamp(bottomRightY, 0.f, float(m_Height));
-
-			//RENDER LOGIC
-			for (int px{ int(topLeftX) }; px < bottomRightX; ++px)
-			{
-				for (int py{ int(bottomRightY) }; py < topLeftY; ++py)
-				{
-					if (m_VisBox)
-					{
-						ColorRGB finalColor{ 1.f,1.f,1.f };
-
-						m_pBackBufferPixels[px + (py * m_Width)] = SDL_MapRGB(m_pBackBuffer->format,
-							static_cast<uint8_t>(finalColor.r * 255),
-							static_cast<uint8_t>(finalColor.g * 255),
-							static_cast<uint8_t>(finalColor.b * 255));
-
-						continue;
-					}
-
-					dae::Vector2 pixel{ float(px + 0.5f), float(py + 0.5f) };
-					ColorRGB finalColor{ 0.0f, 0.0f, 0.0f };
-
-					// Define the edges of the screen triangle
-					const dae::Vector2 AB{ A.position.GetXY(), B.position.GetXY() };
-					const dae::Vector2 BC{ B.position.GetXY(), C.position.GetXY() };
-					const dae::Vector2 CA{ C.position.GetXY(), A.position.GetXY() };
-
-					const float signedAreaAB{ dae::Vector2::Cross(AB, dae::Vector2{ A.position.GetXY(), pixel}) };
-					const float signedAreaBC{ dae::Vector2::Cross(BC, dae::Vector2{ B.position.GetXY(), pixel}) };
-					const float signedAreaCA{ dae::Vector2::Cross(CA, dae::Vector2{ C.position.GetXY(), pixel}) };
-					const float triangleArea = dae::Vector2::Cross(AB, -CA);
-
-					if (signedAreaAB >= 0 && signedAreaBC >= 0 && signedAreaCA >= 0)
-					{
-						const float wA{ signedAreaBC / triangleArea };
-						const float wB{ signedAreaCA / triangleArea };
-						const float wC{ signedAreaAB / triangleArea };
-
-						const float bufferValueZ{ 1 / ((1 / A.position.z) * wA + (1 / B.position.z) * wB + (1 / C.position.z) * wC) }; //interpolated depth (non linear)
-
-						if (bufferValueZ > m_pDepthBufferPixels[px + (py * m_Width)])
-							continue;
-
-						m_pDepthBufferPixels[px + (py * m_Width)] = bufferValueZ;
-
-						float interpolatedW{ 1 / ((1 / A.position.w) * wA + (1 / B.position.w) * wB + (1 / C.position.w) * wC) }; // interpolated depth (linear)
-
-						dae::Vector2 uvInterpolated{
-							(A.uv / A.position.w) * wA +
-							(B.uv / B.position.w) * wB +
-							(C.uv / C.position.w) * wC
-						};
-						uvInterpolated *= interpolatedW;
-
-						Vector3 normalInterpolated{
-							(A.normal / A.position.w) * wA +
-							(B.normal / B.position.w) * wB +
-							(C.normal / C.position.w) * wC
-						};
-						normalInterpolated *= interpolatedW;
-						normalInterpolated.Normalize();
-
-						Vector3 tangentInterpolated{
-							(A.tangent / A.position.w) * wA +
-							(B.tangent / B.position.w) * wB +
-							(C.tangent / C.position.w) * wC
-						};
-						tangentInterpolated *= interpolatedW;
-						tangentInterpolated.Normalize();
-
-						Vector3 viewDirectionInterpolated{
-							(A.viewDirection / A.position.w) * wA +
-							(B.viewDirection / B.position.w) * wB +
-							(C.viewDirection / C.position.w) * wC
-						};
-						viewDirectionInterpolated *= interpolatedW;
-						viewDirectionInterpolated.Normalize();
-
-						Vertex_Out vertexOut{};
-						vertexOut.uv = uvInterpolated;
-						vertexOut.normal = normalInterpolated;
-						vertexOut.tangent = tangentInterpolated;
-						vertexOut.viewDirection = viewDirectionInterpolated;
-
-
-						if (m_VisBuffer)
-						{
-							const float min{ 0.995f };
-							const float max{ 1.0f };
-							float depthColor = (Clamp(bufferValueZ, min, max) - min) * (1.0f / (max - min));
-							finalColor = { depthColor, depthColor, depthColor };
-						}
-						else
-						{
-							finalColor = PixelShading(vertexOut);
-						}
-
-						//Update Color in Buffer
-						finalColor.MaxToOne();
-
-
-						m_pBackBufferPixels[px + (py * m_Width)] = SDL_MapRGB(m_pBackBuffer->format,
-							static_cast<uint8_t>(finalColor.r * 255),
-							static_cast<uint8_t>(finalColor.g * 255),
-							static_cast<uint8_t>(finalColor.b * 255));
-
-					}
-				}
-			}
-		}
+		TIME_STAGE(stageTimers, PipelineStage::Blit);
+		SDL_BlitSurface(m_pBackBuffer, 0, m_pFrontBuffer, 0);
+	}
+	{
+		TIME_STAGE(stageTimers, PipelineStage::Present);
+		SDL_UpdateWindowSurface(m_pWindow);
 	}
 
-	SDL_UnlockSurface(m_pBackBuffer);
-	SDL_BlitSurface(m_pBackBuffer, 0, m_pFrontBuffer, 0);
-	SDL_UpdateWindowSurface(m_pWindow);
+	//Averaged until the next PrintStageTimes
+	for (int stage{}; stage < StageTimers::NrStages; ++stage)
+	{
+		m_StageTimeSums[stage] += stageTimers.GetMilliseconds(static_cast<PipelineStage>(stage));
+	}
+	m_RasterStatsSum += m_pSoftwareRenderer->GetRasterStats();
+	++m_NrTimedFrames;
 }
 
 //Shared
@@ -553,28 +397,32 @@ void Renderer::ToggleRot()
 	}
 	SetConsoleTextAttribute(m_hConsole, m_White);
 }
-void Renderer::ToggleCullMode() const
+void Renderer::ToggleCullMode()
 {
-	if (m_DirectXMode)
-	{
-		SetConsoleTextAttribute(m_hConsole, m_Yellow);
+	//Shared, the software culling follows the hardware rasterizer state
+	m_pMeshRepresentation[0]->ToggleCullMode();
+	SoftwareRenderer::Settings& settings{ m_pSoftwareRenderer->GetSettings() };
 
-		m_pMeshRepresentation[0]->ToggleCullMode();
+	SetConsoleTextAttribute(m_hConsole, m_Yellow);
 
-		if (m_pMeshRepresentation[0]->GetCullMode() == 0)
-		{
-			std::cout << "Front Culling\n";
-		}
-		if (m_pMeshRepresentation[0]->GetCullMode() == 1)
-		{
-			std::cout << "Back Culling\n";
-		}
-		if (m_pMeshRepresentation[0]->GetCullMode() == 2)
-		{
-			std::cout << "No Culling\n";
-		}
-		SetConsoleTextAttribute(m_hConsole, m_White);
+	switch (settings.cullMode)
+	{
+	case CullMode::Back:
+		settings.cullMode = CullMode::None;
+		std::cout << "No Culling\n";
+		break;
+	case CullMode::None:
+		settings.cullMode = CullMode::Front;
+		std::cout << "Front Culling\n";
+		break;
+	case CullMode::Front:
+		settings.cullMode = CullMode::Back;
+		std::cout << "Back Culling\n";
+		break;
+	default:
+		break;
 	}
+	SetConsoleTextAttribute(m_hConsole, m_White);
 }
 void Renderer::ToggleBackGround()
 {
@@ -605,6 +453,54 @@ void Renderer::ToggleFPS(bool FpsOnOff) const
 	}
 	SetConsoleTextAttribute(m_hConsole, m_White);
 }
+void Renderer::WriteTrace() const
+{
+	SetConsoleTextAttribute(m_hConsole, m_Yellow);
+#if ENABLE_PROFILER
+	if (Profiler::Get().WriteTrace("Trace.json"))
+	{
+		std::cout << "Trace Written To Trace.json\n";
+	}
+	else
+	{
+		std::cout << "Trace Could Not Be Written\n";
+	}
+#else
+	std::cout << "Profiler Compiled Out\n";
+#endif
+	SetConsoleTextAttribute(m_hConsole, m_White);
+}
+
+void Renderer::ToggleSampling()
+{
+	//Shared, the software filter follows the techniques of the meshes
+	for (auto& Mesh : m_pMeshRepresentation)
+	{
+		Mesh->ToggleSampling();
+	}
+	SamplerState& samplerState{ m_pSoftwareRenderer->GetSettings().samplerState };
+
+	SetConsoleTextAttribute(m_hConsole, m_Yellow);
+
+	switch (m_pMeshRepresentation[0]->GetSampleState())
+	{
+	case 0:
+		samplerState.filter = SamplerState::Filter::Point;
+		std::cout << "Point\n";
+		break;
+	case 1:
+		samplerState.filter = SamplerState::Filter::Linear;
+		std::cout << "Linear\n";
+		break;
+	case 2:
+		samplerState.filter = SamplerState::Filter::Anisotropic;
+		std::cout << "Anisotropic\n";
+		break;
+	default:
+		break;
+	}
+	SetConsoleTextAttribute(m_hConsole, m_White);
+}
 
 //Hardware
 void Renderer::ToggleFireMesh()
@@ -626,43 +522,17 @@ void Renderer::ToggleFireMesh()
 	}
 	
 }
-void Renderer::ToggleSampling() const
-{
-	if (m_DirectXMode)
-	{
-		SetConsoleTextAttribute(m_hConsole, m_Green);
-
-		for (auto& Mesh : m_pMeshRepresentation)
-		{
-			Mesh->ToggleSampling();
-		}
-		if (m_pMeshRepresentation[0]->GetSampleState() == 0)
-		{
-			std::cout << "Point\n";
-		}
-		if (m_pMeshRepresentation[0]->GetSampleState() == 1)
-		{
-			std::cout << "Linear\n";
-		}
-		if (m_pMeshRepresentation[0]->GetSampleState() == 2)
-		{
-			std::cout << "Anisotropic\n";
-		}
-		SetConsoleTextAttribute(m_hConsole, m_White);
-	}
-	
-}
-
 //Software
 void Renderer::ToggleNor()
 {
+	SoftwareRenderer::Settings& settings{ m_pSoftwareRenderer->GetSettings() };
 	if (!m_DirectXMode)
 	{
-		m_NorEnabled = !m_NorEnabled;
+		settings.normalMapping = !settings.normalMapping;
 
 		SetConsoleTextAttribute(m_hConsole, m_Magenta);
 
-		if(m_NorEnabled)
+		if(settings.normalMapping)
 		{
 			std::cout << "Normals Enabled\n";
 		}
@@ -676,13 +546,14 @@ void Renderer::ToggleNor()
 }
 void Renderer::ToggleBuffer()
 {
+	SoftwareRenderer::Settings& settings{ m_pSoftwareRenderer->GetSettings() };
 	if (!m_DirectXMode)
 	{
-		m_VisBuffer = !m_VisBuffer;
+		settings.depthVisualization = !settings.depthVisualization;
 
 		SetConsoleTextAttribute(m_hConsole, m_Magenta);
 
-		if (m_VisBuffer)
+		if (settings.depthVisualization)
 		{
 			std::cout << "Visual Buffer Enabled\n";
 		}
@@ -696,13 +567,14 @@ void Renderer::ToggleBuffer()
 }
 void Renderer::ToggleBoxVisual()
 {
+	SoftwareRenderer::Settings& settings{ m_pSoftwareRenderer->GetSettings() };
 	if (!m_DirectXMode)
 	{
-		m_VisBox = !m_VisBox;
+		settings.boundingBoxVisualization = !settings.boundingBoxVisualization;
 
 		SetConsoleTextAttribute(m_hConsole, m_Magenta);
 
-		if (m_VisBox)
+		if (settings.boundingBoxVisualization)
 		{
 			std::cout << "Visual Box Enabled\n";
 		}
@@ -716,29 +588,47 @@ void Renderer::ToggleBoxVisual()
 	}
 	
 }
-void Renderer::ToggleLightMode()
+void Renderer::ToggleOverdraw()
 {
+	SoftwareRenderer::Settings& settings{ m_pSoftwareRenderer->GetSettings() };
 	if (!m_DirectXMode)
 	{
+		settings.overdrawVisualization = !settings.overdrawVisualization;
+
 		SetConsoleTextAttribute(m_hConsole, m_Magenta);
 
-		switch (m_CurrentLightmode)
+		if (settings.overdrawVisualization)
 		{
-		case LightMode::Combined:
-			m_CurrentLightmode = LightMode::Diffuse;
-			std::cout << "Diffuse\n";
-			break;
-		case LightMode::Diffuse:
-			m_CurrentLightmode = LightMode::Specular;
-			std::cout << "Specular\n";
+			std::cout << "Visual Overdraw Enabled\n";
+		}
+		else
+		{
+			std::cout << "Visual Overdraw Disabled\n";
+		}
+
+		SetConsoleTextAttribute(m_hConsole, m_White);
+	}
+}
+void Renderer::ToggleMipFilter()
+{
+	SoftwareRenderer::Settings& settings{ m_pSoftwareRenderer->GetSettings() };
+	if (!m_DirectXMode)
+	{
+		SetConsoleTextAttribute(m_hConsole, m_Magenta);
+
+		switch (settings.samplerState.mipFilter)
+		{
+		case SamplerState::MipFilter::Linear:
+			settings.samplerState.mipFilter = SamplerState::MipFilter::None;
+			std::cout << "Mip Filter None\n";
 			break;
-		case LightMode::Specular:
-			m_CurrentLightmode = LightMode::ObservedArea;
-			std::cout << "ObservedArea\n";
+		case SamplerState::MipFilter::None:
+			settings.samplerState.mipFilter = SamplerState::MipFilter::Nearest;
+			std::cout << "Mip Filter Nearest\n";
 			break;
-		case LightMode::ObservedArea:
-			m_CurrentLightmode = LightMode::Combined;
-			std::cout << "Combined\n";
+		case SamplerState::MipFilter::Nearest:
+			settings.samplerState.mipFilter = SamplerState::MipFilter::Linear;
+			std::cout << "Mip Filter Linear\n";
 			break;
 		default:
 			break;
@@ -747,101 +637,140 @@ void Renderer::ToggleLightMode()
 		SetConsoleTextAttribute(m_hConsole, m_White);
 	}
 }
-
-void Renderer::VertexTransformationFunctionW4(std::vector<MeshRasterizer>& meshes) const
+void Renderer::ToggleAddressMode()
 {
-	for (MeshRasterizer& mesh : meshes)
+	SoftwareRenderer::Settings& settings{ m_pSoftwareRenderer->GetSettings() };
+	if (!m_DirectXMode)
 	{
-		const Matrix matrix = mesh.worldMatrix * (m_Camera.viewMatrix * m_Camera.projectionMatrix);
+		SetConsoleTextAttribute(m_hConsole, m_Magenta);
 
-		mesh.vertices_out.clear();
-		mesh.vertices_out.reserve(mesh.vertices.size());
-		for (const Vertex& vertex : mesh.vertices)
+		if (settings.samplerState.addressMode == SamplerState::AddressMode::Wrap)
 		{
-			//Projection stage
-			Vector4 projectionVertex = matrix.TransformPoint({ vertex.position, 1.0f });
-
-			//Conversion to NDC - Perspective Divide (perspective distortion)
-			projectionVertex.x /= projectionVertex.w;
-			projectionVertex.y /= projectionVertex.w;
-			projectionVertex.z /= projectionVertex.w;
-
-			//convert normal and tangent to worldspace, for rotation -> normalize them after
-			const Vector3 normal{ mesh.worldMatrix.TransformVector(vertex.normal).Normalized() };
-			const Vector3 tangent{ mesh.worldMatrix.TransformVector(vertex.tangent).Normalized() };
+			settings.samplerState.addressMode = SamplerState::AddressMode::Clamp;
+			std::cout << "Address Mode Clamp\n";
+		}
+		else
+		{
+			settings.samplerState.addressMode = SamplerState::AddressMode::Wrap;
+			std::cout << "Address Mode Wrap\n";
+		}
 
-			// Calculate vert world position, for viewDirection
-			const Vector3 vertPosition{ mesh.worldMatrix.TransformPoint(vertex.position) };
-			const Vector3 viewDir{ m_Camera.origin - vertPosition };
+		SetConsoleTextAttribute(m_hConsole, m_White);
+	}
+}
+void Renderer::ToggleShadingPath()
+{
+	SoftwareRenderer::Settings& settings{ m_pSoftwareRenderer->GetSettings() };
+	if (!m_DirectXMode)
+	{
+		SetConsoleTextAttribute(m_hConsole, m_Magenta);
 
-			Vertex_Out vertexOut{ projectionVertex, {}, vertex.uv,
-				normal, tangent, viewDir };
+		switch (settings.shadingPath)
+		{
+		case ShadingPath::Forward:
+			settings.shadingPath = ShadingPath::DepthPrePass;
+			std::cout << "Depth Pre-Pass\n";
+			break;
+		case ShadingPath::DepthPrePass:
+			settings.shadingPath = ShadingPath::VisibilityBuffer;
+			std::cout << "Visibility Buffer\n";
+			break;
+		case ShadingPath::VisibilityBuffer:
+			settings.shadingPath = ShadingPath::Forward;
+			std::cout << "Forward\n";
+			break;
+		default:
+			break;
+		}
 
-			mesh.vertices_out.emplace_back(vertexOut);
+		SetConsoleTextAttribute(m_hConsole, m_White);
+	}
+}
+void Renderer::ToggleStageTimes()
+{
+	if (!m_DirectXMode)
+	{
+		m_PrintStageTimes = !m_PrintStageTimes;
+		m_StageTimeSums.fill(0.);
+		m_RasterStatsSum = SoftwareRenderer::RasterStats{};
+		m_NrTimedFrames = 0;
 
+		SetConsoleTextAttribute(m_hConsole, m_Magenta);
 
+#if ENABLE_STAGE_TIMERS
+		if (m_PrintStageTimes)
+		{
+			std::cout << "Print Stage Times ON\n";
 		}
+		else
+		{
+			std::cout << "Print Stage Times OFF\n";
+		}
+#else
+		std::cout << "Stage Timers Compiled Out\n";
+#endif
+		SetConsoleTextAttribute(m_hConsole, m_White);
 	}
 }
-ColorRGB Renderer::PixelShading(const Vertex_Out& v) const
+void Renderer::PrintStageTimes()
 {
-	const Vector3 lightDirection{ .577f, -.577f, .577f };
-	const float lightIntensity{ 7.f };
-	ColorRGB finalColor{};
-
-	//Base color
-	const ColorRGB diffuse{ m_pDiffuseTxt->Sample(v.uv) };
-	const ColorRGB lambert{ (lightIntensity * diffuse) / PI };
-
-	//Normals
-	const Vector3 binormal{ Vector3::Cross(v.normal, v.tangent) };
-	const Matrix tangentSpaceAxis{ v.tangent, binormal, v.normal, Vector3::Zero };
-	Vector3 sampledNormal{ m_pNormalTxt->Sample(v.uv).r, m_pNormalTxt->Sample(v.uv).g, m_pNormalTxt->Sample(v.uv).b };
-	//sampledNormal /= 255.f; // [0, 255] -> [0,1] //doesnt work with this but is in ppt, already done in sample function
-	sampledNormal = 2.f * sampledNormal - Vector3{ 1.f, 1.f, 1.f }; // [0,1] -> [-1, 1]
-	const Vector3 normalTangentSpace{ tangentSpaceAxis.TransformVector(sampledNormal) };
-
-	//Change Normals
-	Vector3 typeOfNormals{};
-	if (m_NorEnabled)
+	if (m_PrintStageTimes && !m_DirectXMode && m_NrTimedFrames != 0)
 	{
-		typeOfNormals = normalTangentSpace;
-	}
-	else
+		//Thread times, on more threads they add up to more than the frame
+		std::cout << "Stage ms/frame:";
+		for (int stage{}; stage < StageTimers::NrStages; ++stage)
+		{
+			std::cout << ' ' << StageTimers::GetName(static_cast<PipelineStage>(stage)) << ' ' << m_StageTimeSums[stage] / m_NrTimedFrames;
+		}
+		std::cout << '\n';
+
+		const SoftwareRenderer::RasterStats& stats{ m_RasterStatsSum };
+		std::cout << "Triangles/frame: submitted " << stats.trianglesSubmitted / m_NrTimedFrames
+			<< " frustum culled " << stats.trianglesFrustumCulled / m_NrTimedFrames
+			<< " backface culled " << stats.trianglesBackfaceCulled / m_NrTimedFrames
+			<< " zero area culled " << stats.trianglesZeroAreaCulled / m_NrTimedFrames
+			<< " tile depth culled " << stats.trianglesDepthCulled / m_NrTimedFrames
+			<< " tile rasterized " << stats.trianglesRasterized / m_NrTimedFrames << '\n';
+
+		//Shaded over tested is how much of the coverage shading actually paid for
+		std::cout << "Pixels/frame: tested " << stats.pixelsTested / m_NrTimedFrames
+			<< " passed depth " << stats.pixelsPassedDepth / m_NrTimedFrames
+			<< " shaded " << stats.pixelsShaded / m_NrTimedFrames
+			<< " per screen pixel " << double(stats.pixelsShaded) / (double(m_Width) * m_Height * m_NrTimedFrames) << '\n';
+	}
+	m_StageTimeSums.fill(0.);
+	m_RasterStatsSum = SoftwareRenderer::RasterStats{};
+	m_NrTimedFrames = 0;
+}
+void Renderer::ToggleLightMode()
+{
+	SoftwareRenderer::Settings& settings{ m_pSoftwareRenderer->GetSettings() };
+	if (!m_DirectXMode)
 	{
-		typeOfNormals = v.normal;
-	}
-	const float observedArea{ Vector3::Dot(typeOfNormals, -lightDirection) };
-
-	if (observedArea < 0.0f)
-		return {};
-
-	//Phong specular
-	const ColorRGB specular{ m_pSpecularTxt->Sample(v.uv) };
-	const ColorRGB gloss{ m_pGlossTxt->Sample(v.uv) };
-	const float shininess{ 25.f };
-	const ColorRGB ambient{ .025f, .025f, .025f };
-
-	const Vector3 reflection{ lightDirection - (2.0f * Vector3::Dot(typeOfNormals, lightDirection) * typeOfNormals) };
-	float dotReflectionViewDir{ std::max(0.f, Vector3::Dot(reflection, v.viewDirection)) }; // so dot is never negative
-	const ColorRGB phong{ specular * powf(dotReflectionViewDir, gloss.r * shininess) }; //r, g, b are the same so we can just use r (greyscale map)
+		SetConsoleTextAttribute(m_hConsole, m_Magenta);
 
+		switch (settings.lightMode)
+		{
+		case LightMode::Combined:
+			settings.lightMode = LightMode::Diffuse;
+			std::cout << "Diffuse\n";
+			break;
+		case LightMode::Diffuse:
+			settings.lightMode = LightMode::Specular;
+			std::cout << "Specular\n";
+			break;
+		case LightMode::Specular:
+			settings.lightMode = LightMode::ObservedArea;
+			std::cout << "ObservedArea\n";
+			break;
+		case LightMode::ObservedArea:
+			settings.lightMode = LightMode::Combined;
+			std::cout << "Combined\n";
+			break;
+		default:
+			break;
+		}
 
-	switch (m_CurrentLightmode)
-	{
-	case Renderer::LightMode::Combined:
-		finalColor = (lambert + phong + ambient) * observedArea;
-		break;
-	case Renderer::LightMode::Diffuse:
-		finalColor = lambert * observedArea;
-		break;
-	case Renderer::LightMode::Specular:
-		finalColor = phong;
-		break;
-	case Renderer::LightMode::ObservedArea:
-		finalColor = { observedArea, observedArea, observedArea };
-		break;
+		SetConsoleTextAttribute(m_hConsole, m_White);
 	}
-	
-	return finalColor;
-}
\ No newline at end of file
+}
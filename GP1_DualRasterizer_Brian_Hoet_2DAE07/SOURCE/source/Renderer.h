@@ -1,13 +1,13 @@
 #pragma once
 #include "Camera.h"
 #include "Texture.h"
+#include "SoftwareRenderer.h"
 
 struct SDL_Window;
 struct SDL_Surface;
 class MeshRepresentation;
 class Texture;
-struct Vertex_Out;
-struct MeshRasterizer;
+class MaterialTexture;
 
 using namespace dae;
 
@@ -30,19 +30,26 @@ using namespace dae;
 		//Shared
 		void ToggleMode();
 		void ToggleRot();
-		void ToggleCullMode() const;
+		void ToggleCullMode();
+		void ToggleSampling(); //one filter for both modes
 		void ToggleBackGround();
 		void ToggleFPS(bool FpsOnOff) const;
+		void WriteTrace() const; //zones of the last frames, for chrome://tracing or ui.perfetto.dev
 
 		//Hardware
 		void ToggleFireMesh();
-		void ToggleSampling() const;
 
 		//Software
 		void ToggleLightMode();
 		void ToggleNor();
+		void ToggleMipFilter();
+		void ToggleAddressMode();
 		void ToggleBuffer();
 		void ToggleBoxVisual();
+		void ToggleOverdraw();
+		void ToggleShadingPath();
+		void ToggleStageTimes();
+		void PrintStageTimes(); //averages since the last print, raster stats included
 
 	private:
 		//Color
@@ -54,6 +61,11 @@ using namespace dae;
 		const int m_White{ 15 };
 		
 		bool m_UniformBackGround{ false };
+
+		using CullMode = SoftwareRenderer::CullMode;
+		using LightMode = SoftwareRenderer::LightMode;
+		using ShadingPath = SoftwareRenderer::ShadingPath;
+
 		bool m_DirectXMode{ true };
 		bool m_RotEnabled{ true };
 		float m_Angle{};
@@ -86,40 +98,26 @@ using namespace dae;
 		void RenderDirectX() const;
 		void UpdateDirectX(const Timer* pTimer);
 
-		//Software
-		bool m_NorEnabled{ true };
-		bool m_VisBuffer{ false };
-		bool m_VisBox{ false };
-
-		enum class LightMode
-		{
-			Combined,
-			Diffuse,
-			Specular,
-			ObservedArea
-
-		};
-
-		LightMode m_CurrentLightmode{ LightMode::Combined };
-
+		//Software, the rasterizer itself lives in SoftwareRenderer
 		SDL_Surface* m_pFrontBuffer{ nullptr };
 		SDL_Surface* m_pBackBuffer{ nullptr };
-		uint32_t* m_pBackBufferPixels{};
-		std::vector<MeshRasterizer> m_pMeshesRast;
+		std::unique_ptr<SoftwareRenderer> m_pSoftwareRenderer;
+		SoftwareScene m_SoftwareScene;
 
-		float* m_pDepthBufferPixels{};
+		bool m_PrintStageTimes{ false };
+		std::array<double, StageTimers::NrStages> m_StageTimeSums{};
+		SoftwareRenderer::RasterStats m_RasterStatsSum{};
+		int m_NrTimedFrames{};
 
 		Texture* m_pDiffuseTxt;
 		Texture* m_pNormalTxt;
 		Texture* m_pSpecularTxt;
 		Texture* m_pGlossTxt;
+		MaterialTexture* m_pMaterialTxt; //the four maps above baked for the rasterizer
 
 		void RenderRasterizer();
 		void UpdateRasterizer(const Timer* pTimer);
 
-		ColorRGB PixelShading(const Vertex_Out& v) const;
-		void VertexTransformationFunctionW4(std::vector<MeshRasterizer>& meshes) const;
-
 		
 
 	};
@@ -0,0 +1,31 @@
+#pragma once
+
+//How the software rasterizer filters and addresses a texture,
+//the CPU counterpart of the sampler states in PosCol3D.fx
+struct SamplerState
+{
+	enum class Filter
+	{
+		Point,
+		Linear, //bilinear inside a mip level
+		Anisotropic //bilinear taps spread along the long axis of the pixel footprint
+	};
+
+	enum class AddressMode
+	{
+		Wrap,
+		Clamp
+	};
+
+	enum class MipFilter
+	{
+		None, //always the full resolution level
+		Nearest, //the closest level
+		Linear //blend of the two closest levels
+	};
+
+	Filter filter{ Filter::Point };
+	AddressMode addressMode{ AddressMode::Wrap };
+	MipFilter mipFilter{ MipFilter::Linear };
+	int maxAnisotropy{ 16 }; //taps at most, the D3D11 default
+};
@@ -0,0 +1,271 @@
+#pragma once
+
+//Standard includes
+#include <cstdint>
+#include <immintrin.h>
+
+namespace dae
+{
+	//8 lanes, the software rasterizer maps them onto a 4x2 pixel block:
+	//lanes 0-3 are the top row and lanes 4-7 the bottom row.
+	//Uses AVX2 when the compiler targets it (/arch:AVX2), two SSE2 halves otherwise.
+	constexpr int SIMD_WIDTH{ 8 };
+	constexpr int SIMD_BLOCK_WIDTH{ 4 };
+	constexpr int SIMD_BLOCK_HEIGHT{ 2 };
+
+	struct SimdFloat
+	{
+#if defined(__AVX2__)
+		__m256 v;
+#else
+		__m128 lo;
+		__m128 hi;
+#endif
+
+		SimdFloat() = default;
+		explicit SimdFloat(float value);
+		SimdFloat(float l0, float l1, float l2, float l3, float l4, float l5, float l6, float l7);
+
+		//Both rows hold 4 floats, no alignment needed
+		static SimdFloat LoadBlock(const float* pRow0, const float* pRow1);
+		static SimdFloat Load(const float* pLanes);
+		void StoreBlock(float* pRow0, float* pRow1) const;
+		void Store(float* pLanes) const;
+	};
+
+	struct SimdInt
+	{
+#if defined(__AVX2__)
+		__m256i v;
+#else
+		__m128i lo;
+		__m128i hi;
+#endif
+
+		SimdInt() = default;
+		explicit SimdInt(int32_t value);
+		SimdInt(int32_t l0, int32_t l1, int32_t l2, int32_t l3, int32_t l4, int32_t l5, int32_t l6, int32_t l7);
+
+		//Same block layout as SimdFloat
+		static SimdInt Load(const uint32_t* pLanes);
+		void StoreBlock(uint32_t* pRow0, uint32_t* pRow1) const;
+		void Store(uint32_t* pLanes) const;
+	};
+
+#if defined(__AVX2__)
+	inline SimdFloat::SimdFloat(float value) : v{ _mm256_set1_ps(value) } {}
+	inline SimdFloat::SimdFloat(float l0, float l1, float l2, float l3, float l4, float l5, float l6, float l7) :
+		v{ _mm256_setr_ps(l0, l1, l2, l3, l4, l5, l6, l7) } {}
+
+	inline SimdFloat SimdFloat::LoadBlock(const float* pRow0, const float* pRow1)
+	{
+		SimdFloat result;
+		result.v = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(pRow0)), _mm_loadu_ps(pRow1), 1);
+		return result;
+	}
+	inline void SimdFloat::StoreBlock(float* pRow0, float* pRow1) const
+	{
+		_mm_storeu_ps(pRow0, _mm256_castps256_ps128(v));
+		_mm_storeu_ps(pRow1, _mm256_extractf128_ps(v, 1));
+	}
+	inline SimdFloat SimdFloat::Load(const float* pLanes)
+	{
+		SimdFloat result;
+		result.v = _mm256_loadu_ps(pLanes);
+		return result;
+	}
+	inline void SimdFloat::Store(float* pLanes) const { _mm256_storeu_ps(pLanes, v); }
+
+	inline SimdInt::SimdInt(int32_t value) : v{ _mm256_set1_epi32(value) } {}
+	inline SimdInt::SimdInt(int32_t l0, int32_t l1, int32_t l2, int32_t l3, int32_t l4, int32_t l5, int32_t l6, int32_t l7) :
+		v{ _mm256_setr_epi32(l0, l1, l2, l3, l4, l5, l6, l7) } {}
+	inline void SimdInt::StoreBlock(uint32_t* pRow0, uint32_t* pRow1) const
+	{
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(pRow0), _mm256_castsi256_si128(v));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(pRow1), _mm256_extracti128_si256(v, 1));
+	}
+	inline SimdInt SimdInt::Load(const uint32_t* pLanes)
+	{
+		SimdInt r;
+		r.v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pLanes));
+		return r;
+	}
+	inline void SimdInt::Store(uint32_t* pLanes) const { _mm256_storeu_si256(reinterpret_cast<__m256i*>(pLanes), v); }
+
+#define SIMD_FLOAT_OP(op, intrinsic) \
+	inline SimdFloat operator op(const SimdFloat& a, const SimdFloat& b) { SimdFloat r; r.v = intrinsic(a.v, b.v); return r; }
+#define SIMD_INT_OP(op, intrinsic) \
+	inline SimdInt operator op(const SimdInt& a, const SimdInt& b) { SimdInt r; r.v = intrinsic(a.v, b.v); return r; }
+
+	SIMD_FLOAT_OP(+, _mm256_add_ps)
+	SIMD_FLOAT_OP(-, _mm256_sub_ps)
+	SIMD_FLOAT_OP(*, _mm256_mul_ps)
+	SIMD_FLOAT_OP(/, _mm256_div_ps)
+	SIMD_INT_OP(+, _mm256_add_epi32)
+	SIMD_INT_OP(-, _mm256_sub_epi32)
+	SIMD_INT_OP(|, _mm256_or_si256)
+	SIMD_INT_OP(&, _mm256_and_si256)
+
+	inline SimdFloat Sqrt(const SimdFloat& a) { SimdFloat r; r.v = _mm256_sqrt_ps(a.v); return r; }
+	inline SimdFloat Min(const SimdFloat& a, const SimdFloat& b) { SimdFloat r; r.v = _mm256_min_ps(a.v, b.v); return r; }
+	inline SimdFloat Max(const SimdFloat& a, const SimdFloat& b) { SimdFloat r; r.v = _mm256_max_ps(a.v, b.v); return r; }
+	inline SimdInt ShiftLeft(const SimdInt& a, int count) { SimdInt r; r.v = _mm256_sll_epi32(a.v, _mm_cvtsi32_si128(count)); return r; }
+	inline SimdInt ShiftRight(const SimdInt& a, int count) { SimdInt r; r.v = _mm256_srl_epi32(a.v, _mm_cvtsi32_si128(count)); return r; } //zeroes shift in
+	inline SimdFloat Floor(const SimdFloat& a) { SimdFloat r; r.v = _mm256_floor_ps(a.v); return r; }
+
+	//Lane masks are returned as bits, lane 0 in bit 0
+	inline int LessEqualMask(const SimdFloat& a, const SimdFloat& b) { return _mm256_movemask_ps(_mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ)); }
+	inline int EqualMask(const SimdFloat& a, const SimdFloat& b) { return _mm256_movemask_ps(_mm256_cmp_ps(a.v, b.v, _CMP_EQ_OQ)); }
+	inline int SignMask(const SimdInt& a) { return _mm256_movemask_ps(_mm256_castsi256_ps(a.v)); }
+
+	//Keeps a where the mask bit is set, b elsewhere
+	inline SimdFloat Select(int mask, const SimdFloat& a, const SimdFloat& b)
+	{
+		const __m256i bits{ _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128) };
+		const __m256i laneMask{ _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(mask), bits), bits) };
+		SimdFloat r;
+		r.v = _mm256_blendv_ps(b.v, a.v, _mm256_castsi256_ps(laneMask));
+		return r;
+	}
+
+	inline SimdFloat ToFloat(const SimdInt& a) { SimdFloat r; r.v = _mm256_cvtepi32_ps(a.v); return r; }
+	inline SimdInt TruncateToInt(const SimdFloat& a) { SimdInt r; r.v = _mm256_cvttps_epi32(a.v); return r; }
+#else
+	inline SimdFloat::SimdFloat(float value) : lo{ _mm_set1_ps(value) }, hi{ lo } {}
+	inline SimdFloat::SimdFloat(float l0, float l1, float l2, float l3, float l4, float l5, float l6, float l7) :
+		lo{ _mm_setr_ps(l0, l1, l2, l3) }, hi{ _mm_setr_ps(l4, l5, l6, l7) } {}
+
+	inline SimdFloat SimdFloat::LoadBlock(const float* pRow0, const float* pRow1)
+	{
+		SimdFloat result;
+		result.lo = _mm_loadu_ps(pRow0);
+		result.hi = _mm_loadu_ps(pRow1);
+		return result;
+	}
+	inline void SimdFloat::StoreBlock(float* pRow0, float* pRow1) const
+	{
+		_mm_storeu_ps(pRow0, lo);
+		_mm_storeu_ps(pRow1, hi);
+	}
+	inline SimdFloat SimdFloat::Load(const float* pLanes)
+	{
+		SimdFloat result;
+		result.lo = _mm_loadu_ps(pLanes);
+		result.hi = _mm_loadu_ps(pLanes + 4);
+		return result;
+	}
+	inline void SimdFloat::Store(float* pLanes) const
+	{
+		_mm_storeu_ps(pLanes, lo);
+		_mm_storeu_ps(pLanes + 4, hi);
+	}
+
+	inline SimdInt::SimdInt(int32_t value) : lo{ _mm_set1_epi32(value) }, hi{ lo } {}
+	inline SimdInt::SimdInt(int32_t l0, int32_t l1, int32_t l2, int32_t l3, int32_t l4, int32_t l5, int32_t l6, int32_t l7) :
+		lo{ _mm_setr_epi32(l0, l1, l2, l3) }, hi{ _mm_setr_epi32(l4, l5, l6, l7) } {}
+	inline void SimdInt::StoreBlock(uint32_t* pRow0, uint32_t* pRow1) const
+	{
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(pRow0), lo);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(pRow1), hi);
+	}
+	inline SimdInt SimdInt::Load(const uint32_t* pLanes)
+	{
+		SimdInt r;
+		r.lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pLanes));
+		r.hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pLanes + 4));
+		return r;
+	}
+	inline void SimdInt::Store(uint32_t* pLanes) const { StoreBlock(pLanes, pLanes + 4); }
+
+#define SIMD_FLOAT_OP(op, intrinsic) \
+	inline SimdFloat operator op(const SimdFloat& a, const SimdFloat& b) { SimdFloat r; r.lo = intrinsic(a.lo, b.lo); r.hi = intrinsic(a.hi, b.hi); return r; }
+#define SIMD_INT_OP(op, intrinsic) \
+	inline SimdInt operator op(const SimdInt& a, const SimdInt& b) { SimdInt r; r.lo = intrinsic(a.lo, b.lo); r.hi = intrinsic(a.hi, b.hi); return r; }
+
+	SIMD_FLOAT_OP(+, _mm_add_ps)
+	SIMD_FLOAT_OP(-, _mm_sub_ps)
+	SIMD_FLOAT_OP(*, _mm_mul_ps)
+	SIMD_FLOAT_OP(/, _mm_div_ps)
+	SIMD_INT_OP(+, _mm_add_epi32)
+	SIMD_INT_OP(-, _mm_sub_epi32)
+	SIMD_INT_OP(|, _mm_or_si128)
+	SIMD_INT_OP(&, _mm_and_si128)
+
+	inline SimdFloat Sqrt(const SimdFloat& a) { SimdFloat r; r.lo = _mm_sqrt_ps(a.lo); r.hi = _mm_sqrt_ps(a.hi); return r; }
+	inline SimdFloat Min(const SimdFloat& a, const SimdFloat& b) { SimdFloat r; r.lo = _mm_min_ps(a.lo, b.lo); r.hi = _mm_min_ps(a.hi, b.hi); return r; }
+	inline SimdFloat Max(const SimdFloat& a, const SimdFloat& b) { SimdFloat r; r.lo = _mm_max_ps(a.lo, b.lo); r.hi = _mm_max_ps(a.hi, b.hi); return r; }
+	inline SimdInt ShiftLeft(const SimdInt& a, int count)
+	{
+		const __m128i shift{ _mm_cvtsi32_si128(count) };
+		SimdInt r;
+		r.lo = _mm_sll_epi32(a.lo, shift);
+		r.hi = _mm_sll_epi32(a.hi, shift);
+		return r;
+	}
+	inline SimdInt ShiftRight(const SimdInt& a, int count) //zeroes shift in
+	{
+		const __m128i shift{ _mm_cvtsi32_si128(count) };
+		SimdInt r;
+		r.lo = _mm_srl_epi32(a.lo, shift);
+		r.hi = _mm_srl_epi32(a.hi, shift);
+		return r;
+	}
+	//SSE2 has no rounding instruction: truncate, then step down where that rounded a negative value up
+	inline SimdFloat Floor(const SimdFloat& a)
+	{
+		const __m128 one{ _mm_set1_ps(1.f) };
+		const __m128 truncatedLo{ _mm_cvtepi32_ps(_mm_cvttps_epi32(a.lo)) };
+		const __m128 truncatedHi{ _mm_cvtepi32_ps(_mm_cvttps_epi32(a.hi)) };
+		SimdFloat r;
+		r.lo = _mm_sub_ps(truncatedLo, _mm_and_ps(_mm_cmpgt_ps(truncatedLo, a.lo), one));
+		r.hi = _mm_sub_ps(truncatedHi, _mm_and_ps(_mm_cmpgt_ps(truncatedHi, a.hi), one));
+		return r;
+	}
+
+	//Lane masks are returned as bits, lane 0 in bit 0
+	inline int LessEqualMask(const SimdFloat& a, const SimdFloat& b)
+	{
+		return _mm_movemask_ps(_mm_cmple_ps(a.lo, b.lo)) | (_mm_movemask_ps(_mm_cmple_ps(a.hi, b.hi)) << 4);
+	}
+	inline int EqualMask(const SimdFloat& a, const SimdFloat& b)
+	{
+		return _mm_movemask_ps(_mm_cmpeq_ps(a.lo, b.lo)) | (_mm_movemask_ps(_mm_cmpeq_ps(a.hi, b.hi)) << 4);
+	}
+	inline int SignMask(const SimdInt& a)
+	{
+		return _mm_movemask_ps(_mm_castsi128_ps(a.lo)) | (_mm_movemask_ps(_mm_castsi128_ps(a.hi)) << 4);
+	}
+
+	//Keeps a where the mask bit is set, b elsewhere
+	inline SimdFloat Select(int mask, const SimdFloat& a, const SimdFloat& b)
+	{
+		const __m128i bits{ _mm_setr_epi32(1, 2, 4, 8) };
+		const __m128 maskLo{ _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(_mm_set1_epi32(mask), bits), bits)) };
+		const __m128 maskHi{ _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(_mm_set1_epi32(mask >> 4), bits), bits)) };
+		SimdFloat r;
+		r.lo = _mm_or_ps(_mm_and_ps(maskLo, a.lo), _mm_andnot_ps(maskLo, b.lo));
+		r.hi = _mm_or_ps(_mm_and_ps(maskHi, a.hi), _mm_andnot_ps(maskHi, b.hi));
+		return r;
+	}
+
+	inline SimdFloat ToFloat(const SimdInt& a) { SimdFloat r; r.lo = _mm_cvtepi32_ps(a.lo); r.hi = _mm_cvtepi32_ps(a.hi); return r; }
+	inline SimdInt TruncateToInt(const SimdFloat& a) { SimdInt r; r.lo = _mm_cvttps_epi32(a.lo); r.hi = _mm_cvttps_epi32(a.hi); return r; }
+#endif
+
+#undef SIMD_FLOAT_OP
+#undef SIMD_INT_OP
+
+	inline SimdFloat operator*(const SimdFloat& a, float s) { return a * SimdFloat{ s }; }
+	inline SimdFloat operator*(float s, const SimdFloat& a) { return a * SimdFloat{ s }; }
+
+	inline SimdFloat Reciprocal(const SimdFloat& a) { return SimdFloat{ 1.f } / a; }
+
+	//Normalizes the 3D vectors held in (x, y, z) lane by lane
+	inline void Normalize(SimdFloat& x, SimdFloat& y, SimdFloat& z)
+	{
+		const SimdFloat inverseLength{ Reciprocal(Sqrt(x * x + y * y + z * z)) };
+		x = x * inverseLength;
+		y = y * inverseLength;
+		z = z * inverseLength;
+	}
+}
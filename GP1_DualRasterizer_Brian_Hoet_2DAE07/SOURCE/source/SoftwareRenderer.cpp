@@ -0,0 +1,1394 @@
+#include "pch.h"
+#include "SoftwareRenderer.h"
+#include "MaterialTexture.h"
+#include "DepthRasterizer.h"
+#include "Profiler.h"
+#include <bit>
+#include <cassert>
+
+using namespace dae;
+
+//Clip space outcode bits, set when a vertex is outside that plane
+constexpr int CLIP_NEAR{ 1 << 0 };
+constexpr int CLIP_FAR{ 1 << 1 };
+constexpr int CLIP_GUARD_LEFT{ 1 << 2 };
+constexpr int CLIP_GUARD_RIGHT{ 1 << 3 };
+constexpr int CLIP_GUARD_BOTTOM{ 1 << 4 };
+constexpr int CLIP_GUARD_TOP{ 1 << 5 };
+constexpr int OUTSIDE_LEFT{ 1 << 6 };
+constexpr int OUTSIDE_RIGHT{ 1 << 7 };
+constexpr int OUTSIDE_BOTTOM{ 1 << 8 };
+constexpr int OUTSIDE_TOP{ 1 << 9 };
+constexpr int OUTSIDE_FRUSTUM_XY{ OUTSIDE_LEFT | OUTSIDE_RIGHT | OUTSIDE_BOTTOM | OUTSIDE_TOP }; //culling only, the guard band covers x/y
+constexpr int NR_CLIP_PLANES{ 6 };
+constexpr int MAX_CLIPPED_VERTICES{ 3 + NR_CLIP_PLANES };
+
+const Vector3 LIGHT_DIRECTION{ .577f, -.577f, .577f };
+constexpr float LIGHT_INTENSITY{ 7.f };
+constexpr float SHININESS{ 25.f };
+
+//Vertex the clipper works on, packed so the attributes lerp in one loop
+struct ClipVertex
+{
+	Vector4 position{};
+	float attributes[NrVertexAttributes]{};
+};
+
+//guardBand is the NDC extent of the guard band on that axis
+static int GetOutcode(const Vector4& position, float guardBandX, float guardBandY)
+{
+	const float x{ position.x };
+	const float y{ position.y };
+	const float z{ position.z };
+	const float w{ position.w };
+
+	int outcode{};
+	outcode |= z < 0.f ? CLIP_NEAR : 0;
+	outcode |= z > w ? CLIP_FAR : 0;
+	outcode |= x < -guardBandX * w ? CLIP_GUARD_LEFT : 0;
+	outcode |= x > guardBandX * w ? CLIP_GUARD_RIGHT : 0;
+	outcode |= y < -guardBandY * w ? CLIP_GUARD_BOTTOM : 0;
+	outcode |= y > guardBandY * w ? CLIP_GUARD_TOP : 0;
+	outcode |= x < -w ? OUTSIDE_LEFT : 0;
+	outcode |= x > w ? OUTSIDE_RIGHT : 0;
+	outcode |= y < -w ? OUTSIDE_BOTTOM : 0;
+	outcode |= y > w ? OUTSIDE_TOP : 0;
+	return outcode;
+}
+
+//Signed distance to a clip plane in clip space, inside when >= 0
+static float GetClipDistance(const Vector4& position, int plane, float guardBandX, float guardBandY)
+{
+	switch (plane)
+	{
+	case CLIP_NEAR:
+		return position.z;
+	case CLIP_FAR:
+		return position.w - position.z;
+	case CLIP_GUARD_LEFT:
+		return position.x + guardBandX * position.w;
+	case CLIP_GUARD_RIGHT:
+		return guardBandX * position.w - position.x;
+	case CLIP_GUARD_BOTTOM:
+		return position.y + guardBandY * position.w;
+	case CLIP_GUARD_TOP:
+		return guardBandY * position.w - position.y;
+	default:
+		return 0.f;
+	}
+}
+
+//Perspective divide and viewport mapping: screen space x/y in pixels, NDC z and view space w
+static Vector4 ProjectToScreen(const Vector4& position, float width, float height)
+{
+	return Vector4{
+		(position.x / position.w + 1) / 2.0f * width,
+		(1 - position.y / position.w) / 2.0f * height,
+		position.z / position.w,
+		position.w };
+}
+
+//Clip space position and attributes are linear along an edge before the divide
+static ClipVertex LerpVertex(const ClipVertex& a, const ClipVertex& b, float factor)
+{
+	ClipVertex vertex{};
+	vertex.position = a.position + (b.position - a.position) * factor;
+	for (int attribute{}; attribute < NrVertexAttributes; ++attribute)
+	{
+		vertex.attributes[attribute] = a.attributes[attribute] + (b.attributes[attribute] - a.attributes[attribute]) * factor;
+	}
+	return vertex;
+}
+
+//Sutherland-Hodgman against every plane in planes, writes the convex polygon and returns its vertex count
+static int ClipTriangle(const ClipVertex& a, const ClipVertex& b, const ClipVertex& c, int planes, float guardBandX, float guardBandY, ClipVertex* pPolygon)
+{
+	ClipVertex buffer[MAX_CLIPPED_VERTICES];
+	ClipVertex* pInput{ buffer };
+	ClipVertex* pOutput{ pPolygon };
+
+	pInput[0] = a;
+	pInput[1] = b;
+	pInput[2] = c;
+	int nrInput{ 3 };
+
+	for (int plane{ 1 }; plane < (1 << NR_CLIP_PLANES) && nrInput > 0; plane <<= 1)
+	{
+		if ((planes & plane) == 0)
+			continue;
+
+		int nrOutput{};
+		for (int index{}; index < nrInput; ++index)
+		{
+			const ClipVertex& current{ pInput[index] };
+			const ClipVertex& next{ pInput[(index + 1) % nrInput] };
+			const float currentDistance{ GetClipDistance(current.position, plane, guardBandX, guardBandY) };
+			const float nextDistance{ GetClipDistance(next.position, plane, guardBandX, guardBandY) };
+
+			if (currentDistance >= 0.f)
+			{
+				pOutput[nrOutput++] = current;
+			}
+			if ((currentDistance >= 0.f) != (nextDistance >= 0.f))
+			{
+				pOutput[nrOutput++] = LerpVertex(current, next, currentDistance / (currentDistance - nextDistance));
+			}
+		}
+
+		std::swap(pInput, pOutput);
+		nrInput = nrOutput;
+	}
+
+	//The last pass may have ended in the scratch buffer
+	if (pInput != pPolygon)
+	{
+		std::copy_n(pInput, nrInput, pPolygon);
+	}
+	return nrInput;
+}
+
+SoftwareRenderer::RasterStats& SoftwareRenderer::RasterStats::operator+=(const RasterStats& other)
+{
+	trianglesSubmitted += other.trianglesSubmitted;
+	trianglesFrustumCulled += other.trianglesFrustumCulled;
+	trianglesBackfaceCulled += other.trianglesBackfaceCulled;
+	trianglesZeroAreaCulled += other.trianglesZeroAreaCulled;
+	trianglesDepthCulled += other.trianglesDepthCulled;
+	trianglesRasterized += other.trianglesRasterized;
+	pixelsTested += other.pixelsTested;
+	pixelsPassedDepth += other.pixelsPassedDepth;
+	pixelsShaded += other.pixelsShaded;
+	return *this;
+}
+
+SoftwareRenderer::SoftwareRenderer(int width, int height, uint32_t nrThreads) :
+	m_Width{ width },
+	m_Height{ height },
+	m_ThreadPool{ nrThreads },
+	m_StageTimers{ m_ThreadPool.GetNrThreads() }
+{
+	m_DepthBuffer.resize(size_t(m_Width) * m_Height);
+	m_TriangleIdBuffer.resize(size_t(m_Width) * m_Height);
+	m_OverdrawBuffer.resize(size_t(m_Width) * m_Height);
+
+	//Tiles
+	m_NrTilesX = (m_Width + m_TileSize - 1) / m_TileSize;
+	m_NrTilesY = (m_Height + m_TileSize - 1) / m_TileSize;
+	m_BinnedTriangles.resize(m_ThreadPool.GetNrThreads());
+	m_FrameArenas.resize(m_BinnedTriangles.size());
+	m_TriangleIdOffsets.resize(m_BinnedTriangles.size() + 1);
+	m_RasterStatsSlots.resize(m_ThreadPool.GetNrThreads());
+
+	//Hierarchical depth
+	m_NrHiZCellsX = (m_Width + m_HiZCellSize - 1) / m_HiZCellSize;
+	m_HiZCells.resize(m_NrHiZCellsX * ((m_Height + m_HiZCellSize - 1) / m_HiZCellSize));
+	m_HiZTileMax.resize(m_NrTilesX * m_NrTilesY);
+	m_TileDepthCleared.resize(m_NrTilesX * m_NrTilesY);
+}
+
+void SoftwareRenderer::Render(SoftwareScene& scene, const Camera& camera, const SoftwareRenderTarget& target)
+{
+	PROFILE_ZONE("SoftwareRenderer::Render");
+#if defined(DEBUG) || defined(_DEBUG)
+	const size_t nrHeapAllocations{ GetHeapAllocationCount() };
+#endif
+
+	//Draw straight into the caller's buffers
+	m_pScene = &scene;
+	m_pColorPixels = target.pColor;
+	m_ColorFormat = target.colorFormat;
+	m_pDepthBufferPixels = target.pDepth ? target.pDepth : m_DepthBuffer.data();
+	m_ClearUntouchedDepth = target.pDepth != nullptr;
+	m_ClearColor = m_ColorFormat.Pack(m_Settings.clearColor);
+
+	const std::chrono::steady_clock::time_point frameStart{ std::chrono::steady_clock::now() };
+	m_StageTimers.BeginFrame();
+	for (RasterStatsSlot& slot : m_RasterStatsSlots)
+	{
+		slot.stats = RasterStats{};
+	}
+
+	//No full screen clears, the tile passes clear what they use
+	std::fill(m_TileDepthCleared.begin(), m_TileDepthCleared.end(), uint8_t{ 0 });
+	VertexTransformationFunctionW4(m_pScene->meshes, camera);
+
+	//Binning, every job sorts its own share of the triangles into its own bins
+	const uint32_t nrJobs{ static_cast<uint32_t>(m_BinnedTriangles.size()) };
+	m_ThreadPool.ParallelFor(nrJobs, [this, nrJobs](uint32_t job, uint32_t threadIndex)
+		{
+			TIME_STAGE(m_StageTimers, PipelineStage::Setup);
+			BinTriangles(job, nrJobs, m_RasterStatsSlots[threadIndex].stats);
+		});
+
+	//Give every binned triangle a frame wide id for the visibility buffer
+	for (size_t job{}; job < m_BinnedTriangles.size(); ++job)
+	{
+		m_TriangleIdOffsets[job + 1] = m_TriangleIdOffsets[job] + m_BinnedTriangles[job].nrTriangles;
+	}
+
+	//Raster + shade, a tile belongs to one thread so its color and depth need no locking
+	const uint32_t nrTiles{ static_cast<uint32_t>(m_NrTilesX * m_NrTilesY) };
+	if (m_Settings.shadingPath == ShadingPath::DepthPrePass && !m_Settings.boundingBoxVisualization)
+	{
+		m_ThreadPool.ParallelFor(nrTiles, [this](uint32_t tileIndex, uint32_t)
+			{
+				DepthPrePassTile(static_cast<int>(tileIndex));
+			});
+	}
+
+	m_ThreadPool.ParallelFor(nrTiles, [this](uint32_t tileIndex, uint32_t threadIndex)
+		{
+			RasterizeTile(static_cast<int>(tileIndex), m_RasterStatsSlots[threadIndex].stats);
+		});
+
+	//Visibility buffer: the raster pass only stored ids, shade every visible pixel once
+	if (m_Settings.shadingPath == ShadingPath::VisibilityBuffer && !m_Settings.boundingBoxVisualization)
+	{
+		m_ThreadPool.ParallelFor(nrTiles, [this](uint32_t tileIndex, uint32_t threadIndex)
+			{
+				ResolveTile(static_cast<int>(tileIndex), m_RasterStatsSlots[threadIndex].stats);
+			});
+	}
+
+	//Debug view, replaces the shaded colors once every pass is done shading
+	if (m_Settings.overdrawVisualization && !m_Settings.boundingBoxVisualization)
+	{
+		m_ThreadPool.ParallelFor(nrTiles, [this](uint32_t tileIndex, uint32_t)
+			{
+				VisualizeOverdrawTile(static_cast<int>(tileIndex));
+			});
+	}
+
+	m_FrameMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+
+	m_RasterStats = RasterStats{};
+	for (const RasterStatsSlot& slot : m_RasterStatsSlots)
+	{
+		m_RasterStats += slot.stats;
+	}
+
+#if defined(DEBUG) || defined(_DEBUG)
+	//After the first frame only growing arenas may allocate: an overflow this frame, the bigger block at the next reset
+	const bool frameArenasOverflowed{ std::any_of(m_FrameArenas.begin(), m_FrameArenas.end(), [](const FrameArena& arena) { return arena.HasOverflowed(); }) };
+	assert((m_NrRenderedFrames == 0 || frameArenasOverflowed || m_FrameArenasOverflowed || GetHeapAllocationCount() == nrHeapAllocations)
+		&& "The software frame loop allocated on the heap");
+	m_FrameArenasOverflowed = frameArenasOverflowed;
+	++m_NrRenderedFrames;
+#endif
+
+	m_pScene = nullptr;
+}
+
+void SoftwareRenderer::BinTriangles(uint32_t job, uint32_t nrJobs, RasterStats& stats)
+{
+	PROFILE_ZONE("BinTriangles");
+	const int nrTiles{ m_NrTilesX * m_NrTilesY };
+
+	//Everything this job produces lives in its arena until the job runs again next frame
+	FrameArena& arena{ m_FrameArenas[job] };
+	arena.Reset();
+
+	//Each job takes one contiguous range of all triangles, so the bins keep the submission order
+	auto getNrTriangles = [](const MeshRasterizer& mesh) -> size_t
+	{
+		if (mesh.indices.size() < 3)
+			return 0;
+
+		return mesh.primitiveTopology == PrimitiveTopology::TriangleList ? mesh.indices.size() / 3 : mesh.indices.size() - 2;
+	};
+
+	size_t nrTriangles{};
+	for (const auto& mesh : m_pScene->meshes)
+	{
+		nrTriangles += getNrTriangles(mesh);
+	}
+	const size_t jobFirst{ nrTriangles * job / nrJobs };
+	const size_t jobLast{ nrTriangles * (job + 1) / nrJobs };
+
+	//Calls func(vertices, indexA, indexB, indexC) for every non degenerate triangle of this job
+	auto forEachTriangle = [&](const auto& func)
+	{
+		size_t meshFirst{};
+		for (const auto& mesh : m_pScene->meshes)
+		{
+			const size_t meshLast{ meshFirst + getNrTriangles(mesh) };
+			const size_t first{ std::max(jobFirst, meshFirst) - meshFirst };
+			const size_t last{ std::min(jobLast, meshLast) - meshFirst };
+			meshFirst = meshLast;
+
+			for (size_t triangleIndex{ first }; triangleIndex < last; ++triangleIndex)
+			{
+				//Points of the Triangle
+				size_t i{ triangleIndex };
+				if (mesh.primitiveTopology == PrimitiveTopology::TriangleList)
+				{
+					i *= 3;
+				}
+
+				const uint32_t indexA{ mesh.indices[i] };
+				uint32_t indexB{ mesh.indices[i + 1] };
+				uint32_t indexC{ mesh.indices[i + 2] };
+
+				if (mesh.primitiveTopology == PrimitiveTopology::TriangleStrip)
+				{
+					if (i % 2 != 0)
+					{
+						std::swap(indexB, indexC);
+					}
+
+					if (indexA == indexB)
+						continue;
+
+					if (indexB == indexC)
+						continue;
+
+					if (indexC == indexA)
+						continue;
+				}
+
+				func(mesh.vertices_out, indexA, indexB, indexC);
+			}
+		}
+	};
+
+	//Frustum culling in clip space, only when all three are outside the same plane
+	//Otherwise returns the near, far and guard band planes the triangle has to be clipped against
+	auto getClipPlanes = [](const TransformedVertices& vertices, uint32_t indexA, uint32_t indexB, uint32_t indexC) -> int
+	{
+		const int32_t* pOutcodes{ vertices.GetOutcodes() };
+		const int outcodeA{ pOutcodes[indexA] };
+		const int outcodeB{ pOutcodes[indexB] };
+		const int outcodeC{ pOutcodes[indexC] };
+		if ((outcodeA & outcodeB & outcodeC) != 0)
+			return -1;
+
+		return (outcodeA | outcodeB | outcodeC) & ~OUTSIDE_FRUSTUM_XY;
+	};
+
+	//One setup record per triangle, except that a clipped triangle fans out into up to MAX_CLIPPED_VERTICES - 2.
+	//Counting those first gives one exact size allocation, so the records stay contiguous for the id lookup.
+	size_t nrClippedTriangles{};
+	forEachTriangle([&](const TransformedVertices& vertices, uint32_t indexA, uint32_t indexB, uint32_t indexC)
+		{
+			nrClippedTriangles += getClipPlanes(vertices, indexA, indexB, indexC) > 0 ? 1 : 0;
+		});
+
+	TriangleSetup* pTriangles{ arena.Allocate<TriangleSetup>((jobLast - jobFirst) + nrClippedTriangles * (MAX_CLIPPED_VERTICES - 3)) };
+	uint32_t nrSetupTriangles{};
+
+	//Guard band in NDC units, only triangles reaching past it need x/y clipping
+	const float guardBandX{ 2 * GUARD_BAND_COORDINATE / m_Width - 1 };
+	const float guardBandY{ 2 * GUARD_BAND_COORDINATE / m_Height - 1 };
+
+	//Strip triangles with a repeated index never reach the callback
+	size_t nrVisitedTriangles{};
+	forEachTriangle([&](const TransformedVertices& vertices, uint32_t indexA, uint32_t indexB, uint32_t indexC)
+		{
+			++nrVisitedTriangles;
+			const int clipPlanes{ getClipPlanes(vertices, indexA, indexB, indexC) };
+			if (clipPlanes < 0)
+			{
+				++stats.trianglesFrustumCulled;
+				return;
+			}
+
+			//Clip against near, far and the guard band before the perspective divide
+			if (clipPlanes == 0)
+			{
+				nrSetupTriangles += SetupTriangle(pTriangles[nrSetupTriangles],
+					vertices.GetScreenPosition(indexA), vertices.GetScreenPosition(indexB), vertices.GetScreenPosition(indexC),
+					vertices.GetAttributes(indexA), vertices.GetAttributes(indexB), vertices.GetAttributes(indexC), stats) ? 1 : 0;
+				return;
+			}
+
+			//Only triangles that need clipping get their vertices gathered out of the streams
+			auto gatherVertex = [&vertices](uint32_t index)
+			{
+				ClipVertex vertex{ vertices.GetClipPosition(index) };
+				const VertexAttributes attributes{ vertices.GetAttributes(index) };
+				for (int attribute{}; attribute < NrVertexAttributes; ++attribute)
+				{
+					vertex.attributes[attribute] = attributes[attribute];
+				}
+				return vertex;
+			};
+
+			ClipVertex polygon[MAX_CLIPPED_VERTICES];
+			const int nrVertices{ ClipTriangle(gatherVertex(indexA), gatherVertex(indexB), gatherVertex(indexC), clipPlanes, guardBandX, guardBandY, polygon) };
+
+			//Vertices created by clipping are only projected here
+			Vector4 screenPolygon[MAX_CLIPPED_VERTICES];
+			for (int vertexIndex{}; vertexIndex < nrVertices; ++vertexIndex)
+			{
+				screenPolygon[vertexIndex] = ProjectToScreen(polygon[vertexIndex].position, float(m_Width), float(m_Height));
+			}
+
+			//The clipped polygon is convex, fan it out into triangles that keep the winding
+			for (int vertexIndex{ 2 }; vertexIndex < nrVertices; ++vertexIndex)
+			{
+				nrSetupTriangles += SetupTriangle(pTriangles[nrSetupTriangles], screenPolygon[0], screenPolygon[vertexIndex - 1], screenPolygon[vertexIndex],
+					VertexAttributes{ polygon[0].attributes }, VertexAttributes{ polygon[vertexIndex - 1].attributes }, VertexAttributes{ polygon[vertexIndex].attributes }, stats) ? 1 : 0;
+			}
+		});
+
+	stats.trianglesSubmitted += jobLast - jobFirst;
+	stats.trianglesZeroAreaCulled += (jobLast - jobFirst) - nrVisitedTriangles;
+
+	//Bin every triangle into the tiles its bounding box touches: count, prefix sum, then fill in submission order
+	auto forEachTile = [this](const TriangleSetup& triangle, const auto& func)
+	{
+		for (int tileY{ triangle.minY / m_TileSize }; tileY <= (triangle.maxY - 1) / m_TileSize; ++tileY)
+		{
+			for (int tileX{ triangle.minX / m_TileSize }; tileX <= (triangle.maxX - 1) / m_TileSize; ++tileX)
+			{
+				func(tileY * m_NrTilesX + tileX);
+			}
+		}
+	};
+
+	uint32_t* pTileOffsets{ arena.Allocate<uint32_t>(nrTiles + 1) };
+	std::fill_n(pTileOffsets, nrTiles + 1, 0);
+	for (uint32_t triangleIndex{}; triangleIndex < nrSetupTriangles; ++triangleIndex)
+	{
+		forEachTile(pTriangles[triangleIndex], [pTileOffsets](int tileIndex) { ++pTileOffsets[tileIndex + 1]; });
+	}
+	for (int tileIndex{}; tileIndex < nrTiles; ++tileIndex)
+	{
+		pTileOffsets[tileIndex + 1] += pTileOffsets[tileIndex];
+	}
+
+	uint32_t* pTileEntries{ arena.Allocate<uint32_t>(pTileOffsets[nrTiles]) };
+	uint32_t* pTileCursors{ arena.Allocate<uint32_t>(nrTiles) };
+	std::copy_n(pTileOffsets, nrTiles, pTileCursors);
+	for (uint32_t triangleIndex{}; triangleIndex < nrSetupTriangles; ++triangleIndex)
+	{
+		forEachTile(pTriangles[triangleIndex], [=](int tileIndex) { pTileEntries[pTileCursors[tileIndex]++] = triangleIndex; });
+	}
+
+	m_BinnedTriangles[job] = BinnedTriangles{ pTriangles, nrSetupTriangles, pTileOffsets, pTileEntries };
+}
+
+bool SoftwareRenderer::SetupTriangle(TriangleSetup& triangle, const Vector4& screenA, const Vector4& screenB, const Vector4& screenC, VertexAttributes attributesA, VertexAttributes attributesB, VertexAttributes attributesC, RasterStats& stats) const
+{
+	//Fills the record in place, it only counts as set up when this returns true
+	Vector4 A{ screenA };
+	Vector4 B{ screenB };
+	Vector4 C{ screenC };
+
+	//Depth range for the hierarchical depth tests, widened a bit for interpolation rounding
+	const float depthMargin{ 1e-6f };
+	triangle.minZ = std::min(A.z, std::min(B.z, C.z)) - depthMargin;
+	triangle.maxZ = std::max(A.z, std::max(B.z, C.z)) + depthMargin;
+
+	//Snap to the sub-pixel grid, everything after this is exact integer math
+	const int64_t xA{ std::llround(A.x * SUB_PIXEL_SCALE) };
+	const int64_t yA{ std::llround(A.y * SUB_PIXEL_SCALE) };
+	int64_t xB{ std::llround(B.x * SUB_PIXEL_SCALE) };
+	int64_t yB{ std::llround(B.y * SUB_PIXEL_SCALE) };
+	int64_t xC{ std::llround(C.x * SUB_PIXEL_SCALE) };
+	int64_t yC{ std::llround(C.y * SUB_PIXEL_SCALE) };
+
+	//Culling on the snapped signed area, front faces are clockwise on screen (positive area)
+	int64_t triangleArea{ (xB - xA) * (yC - yA) - (yB - yA) * (xC - xA) };
+	if (triangleArea == 0)
+	{
+		++stats.trianglesZeroAreaCulled;
+		return false;
+	}
+
+	const bool isFrontFace{ triangleArea > 0 };
+	if ((m_Settings.cullMode == CullMode::Back && !isFrontFace) || (m_Settings.cullMode == CullMode::Front && isFrontFace))
+	{
+		++stats.trianglesBackfaceCulled;
+		return false;
+	}
+
+	//Visible back faces get the front face winding, the edge setup expects a positive area
+	if (!isFrontFace)
+	{
+		std::swap(attributesB, attributesC);
+		std::swap(B, C);
+		std::swap(xB, xC);
+		std::swap(yB, yC);
+		triangleArea = -triangleArea;
+	}
+
+	triangle.edgeBC = EdgeFunction::Create(xB, yB, xC, yC);
+	triangle.edgeCA = EdgeFunction::Create(xC, yC, xA, yA);
+	triangle.edgeAB = EdgeFunction::Create(xA, yA, xB, yB);
+
+	//Pixels whose center can be inside, the shifts round towards -infinity
+	const int64_t minX{ (std::min(xA, std::min(xB, xC)) - SUB_PIXEL_HALF + SUB_PIXEL_SCALE - 1) >> SUB_PIXEL_BITS };
+	const int64_t minY{ (std::min(yA, std::min(yB, yC)) - SUB_PIXEL_HALF + SUB_PIXEL_SCALE - 1) >> SUB_PIXEL_BITS };
+	const int64_t maxX{ ((std::max(xA, std::max(xB, xC)) - SUB_PIXEL_HALF) >> SUB_PIXEL_BITS) + 1 };
+	const int64_t maxY{ ((std::max(yA, std::max(yB, yC)) - SUB_PIXEL_HALF) >> SUB_PIXEL_BITS) + 1 };
+
+	triangle.minX = int(std::clamp<int64_t>(minX, 0, m_Width));
+	triangle.minY = int(std::clamp<int64_t>(minY, 0, m_Height));
+	triangle.maxX = int(std::clamp<int64_t>(maxX, 0, m_Width));
+	triangle.maxY = int(std::clamp<int64_t>(maxY, 0, m_Height));
+
+	if (triangle.minX >= triangle.maxX || triangle.minY >= triangle.maxY)
+	{
+		++stats.trianglesZeroAreaCulled;
+		return false;
+	}
+
+	//Sub-pixel triangles: test their few candidate samples here instead of binning them
+	if ((triangle.maxX - triangle.minX) * (triangle.maxY - triangle.minY) <= 2)
+	{
+		bool coversSample{ false };
+		for (int py{ triangle.minY }; py < triangle.maxY; ++py)
+		{
+			for (int px{ triangle.minX }; px < triangle.maxX; ++px)
+			{
+				const int64_t x{ int64_t(px) * SUB_PIXEL_SCALE + SUB_PIXEL_HALF };
+				const int64_t y{ int64_t(py) * SUB_PIXEL_SCALE + SUB_PIXEL_HALF };
+				coversSample |= (triangle.edgeBC.Evaluate(x, y) | triangle.edgeCA.Evaluate(x, y) | triangle.edgeAB.Evaluate(x, y)) >= 0;
+			}
+		}
+		if (!coversSample)
+		{
+			++stats.trianglesZeroAreaCulled;
+			return false;
+		}
+	}
+
+	//Attribute planes, the barycentric of a vertex is the edge value opposite to it divided by the sum of all three.
+	//The edge values always add up to the sum of the c terms, fill rule bias included,
+	//normalizing by that keeps the barycentrics summing to one on tiny triangles.
+	//Evaluated in double around the bounding box origin, the edge values there can be large.
+	const double inverseArea{ 1.0 / double(triangle.edgeBC.c + triangle.edgeCA.c + triangle.edgeAB.c) };
+	const int64_t originX{ int64_t(triangle.minX) * SUB_PIXEL_SCALE + SUB_PIXEL_HALF };
+	const int64_t originY{ int64_t(triangle.minY) * SUB_PIXEL_SCALE + SUB_PIXEL_HALF };
+	const double originBC{ double(triangle.edgeBC.Evaluate(originX, originY)) };
+	const double originCA{ double(triangle.edgeCA.Evaluate(originX, originY)) };
+	const double originAB{ double(triangle.edgeAB.Evaluate(originX, originY)) };
+
+	auto createPlane = [&](double a, double b, double c) -> AttributePlane
+	{
+		const double dx{ (a * triangle.edgeBC.a + b * triangle.edgeCA.a + c * triangle.edgeAB.a) * SUB_PIXEL_SCALE * inverseArea };
+		const double dy{ (a * triangle.edgeBC.b + b * triangle.edgeCA.b + c * triangle.edgeAB.b) * SUB_PIXEL_SCALE * inverseArea };
+		const double origin{ (a * originBC + b * originCA + c * originAB) * inverseArea };
+		return AttributePlane{ float(dx), float(dy), float(origin) };
+	};
+
+	//Depth is affine on screen as is, the attributes become affine once divided by w
+	triangle.depth = createPlane(A.z, B.z, C.z);
+
+	const double inverseWA{ 1.0 / A.w };
+	const double inverseWB{ 1.0 / B.w };
+	const double inverseWC{ 1.0 / C.w };
+	triangle.inverseW = createPlane(inverseWA, inverseWB, inverseWC);
+
+	for (int attribute{}; attribute < NrVertexAttributes; ++attribute)
+	{
+		triangle.attributes[attribute] = createPlane(attributesA[attribute] * inverseWA, attributesB[attribute] * inverseWB, attributesC[attribute] * inverseWC);
+	}
+
+	return true;
+}
+
+void SoftwareRenderer::DepthPrePassTile(int tileIndex)
+{
+	PROFILE_ZONE("DepthPrePassTile");
+	TIME_STAGE(m_StageTimers, PipelineStage::Raster);
+	if (!HasBinnedTriangles(tileIndex))
+		return;
+
+	ClearTileDepth(tileIndex);
+
+	const int tileMinX{ (tileIndex % m_NrTilesX) * m_TileSize };
+	const int tileMinY{ (tileIndex / m_NrTilesX) * m_TileSize };
+	const int tileMaxX{ std::min(tileMinX + m_TileSize, m_Width) };
+	const int tileMaxY{ std::min(tileMinY + m_TileSize, m_Height) };
+
+	const DepthTarget depthTarget{ m_pDepthBufferPixels, m_Width, m_Height };
+	bool depthChanged{ false };
+
+	for (size_t job{}; job < m_BinnedTriangles.size(); ++job)
+	{
+		const BinnedTriangles& bins{ m_BinnedTriangles[job] };
+		for (uint32_t entry{ bins.pTileOffsets[tileIndex] }; entry < bins.pTileOffsets[tileIndex + 1]; ++entry)
+		{
+			const TriangleSetup& triangle{ bins.pTriangles[bins.pTileEntries[entry]] };
+
+			depthChanged |= DepthRasterizer::RasterizeTriangle(triangle, depthTarget,
+				std::max(triangle.minX, tileMinX), std::max(triangle.minY, tileMinY),
+				std::min(triangle.maxX, tileMaxX), std::min(triangle.maxY, tileMaxY));
+		}
+	}
+
+	//One hierarchical depth refresh for the whole tile, the shading pass rejects with it
+	if (depthChanged)
+	{
+		for (int cellY{ tileMinY }; cellY < tileMaxY; cellY += m_HiZCellSize)
+		{
+			for (int cellX{ tileMinX }; cellX < tileMaxX; cellX += m_HiZCellSize)
+			{
+				UpdateHiZCell(cellX, cellY);
+			}
+		}
+		UpdateHiZTile(tileIndex);
+	}
+}
+
+void SoftwareRenderer::RasterizeTile(int tileIndex, RasterStats& stats)
+{
+	PROFILE_ZONE("RasterizeTile");
+	TIME_STAGE(m_StageTimers, PipelineStage::Raster);
+	//Tiles without triangles end up as just the clear color, and a caller depth buffer as far depth
+	ClearTileColor(tileIndex);
+	if (!HasBinnedTriangles(tileIndex))
+	{
+		if (m_ClearUntouchedDepth)
+		{
+			ClearTileDepth(tileIndex);
+		}
+		return;
+	}
+
+	ClearTileDepth(tileIndex);
+
+	const int tileMinX{ (tileIndex % m_NrTilesX) * m_TileSize };
+	const int tileMinY{ (tileIndex / m_NrTilesX) * m_TileSize };
+	const int tileMaxX{ std::min(tileMinX + m_TileSize, m_Width) };
+	const int tileMaxY{ std::min(tileMinY + m_TileSize, m_Height) };
+
+	//Jobs binned consecutive ranges, so walking them in order draws in submission order
+	for (size_t job{}; job < m_BinnedTriangles.size(); ++job)
+	{
+		const BinnedTriangles& bins{ m_BinnedTriangles[job] };
+		for (uint32_t entry{ bins.pTileOffsets[tileIndex] }; entry < bins.pTileOffsets[tileIndex + 1]; ++entry)
+		{
+			const uint32_t binnedIndex{ bins.pTileEntries[entry] };
+			const TriangleSetup& triangle{ bins.pTriangles[binnedIndex] };
+
+			//The whole tile is already closer than the triangle
+			if (triangle.minZ > m_HiZTileMax[tileIndex] && !m_Settings.boundingBoxVisualization)
+			{
+				++stats.trianglesDepthCulled;
+				continue;
+			}
+
+			++stats.trianglesRasterized;
+			const bool depthChanged{ RasterizeTriangle(triangle, m_TriangleIdOffsets[job] + binnedIndex,
+				std::max(triangle.minX, tileMinX), std::max(triangle.minY, tileMinY),
+				std::min(triangle.maxX, tileMaxX), std::min(triangle.maxY, tileMaxY), stats) };
+
+			if (depthChanged)
+			{
+				UpdateHiZTile(tileIndex);
+			}
+		}
+	}
+}
+
+bool SoftwareRenderer::RasterizeTriangle(const TriangleSetup& triangle, uint32_t triangleId, int minX, int minY, int maxX, int maxY, RasterStats& stats)
+{
+	if (m_Settings.boundingBoxVisualization)
+	{
+		const uint32_t boxColor{ m_ColorFormat.Pack(ColorRGB{ 1.f,1.f,1.f }) };
+
+		for (int py{ minY }; py < maxY; ++py)
+		{
+			std::fill_n(&m_pColorPixels[minX + (py * m_Width)], maxX - minX, boxColor);
+		}
+		return false;
+	}
+
+	const SimdInt laneOffsetBC{ DepthRasterizer::GetLaneOffsets(triangle.edgeBC) };
+	const SimdInt laneOffsetCA{ DepthRasterizer::GetLaneOffsets(triangle.edgeCA) };
+	const SimdInt laneOffsetAB{ DepthRasterizer::GetLaneOffsets(triangle.edgeAB) };
+
+	//After a depth pre-pass the buffer already holds the final depth, only equal samples are shaded
+	const bool depthPrePassed{ m_Settings.shadingPath == ShadingPath::DepthPrePass };
+
+	//Blocks sit on the 4x2 grid, lanes outside [minX, maxX) x [minY, maxY) get masked
+	//acceptAll skips the depth compare when the hierarchical depth proves it passes
+	//Returns whether depth values were written
+	auto rasterizeBlock = [&](int bx, int by, int64_t edgeBC, int64_t edgeCA, int64_t edgeAB, bool acceptAll) -> bool
+	{
+		const int rectMask{ DepthRasterizer::GetRectMask(bx, by, minX, minY, maxX, maxY) };
+		if (rectMask == 0)
+			return false;
+
+		//Coverage: lanes where none of the edge values has its sign bit set
+		const SimdInt laneBC{ DepthRasterizer::ToLane(edgeBC) + laneOffsetBC };
+		const SimdInt laneCA{ DepthRasterizer::ToLane(edgeCA) + laneOffsetCA };
+		const SimdInt laneAB{ DepthRasterizer::ToLane(edgeAB) + laneOffsetAB };
+		const int coverage{ rectMask & ~SignMask(laneBC | laneCA | laneAB) };
+		if (coverage == 0)
+			return false;
+
+		SimdFloat x, y;
+		DepthRasterizer::GetBlockCoordinates(triangle, bx, by, x, y);
+		const SimdFloat bufferValueZ{ DepthRasterizer::GetBlockDepth(triangle, bx, by) }; //interpolated depth (non linear)
+
+		//Depth test, blocks fully inside the rectangle stay in registers
+		const int pixelIndex{ bx + (by * m_Width) };
+		float depthLanes[SIMD_WIDTH];
+		bufferValueZ.Store(depthLanes);
+
+		int visible{};
+		if (rectMask == 0xFF)
+		{
+			float* pDepthRow0{ &m_pDepthBufferPixels[pixelIndex] };
+			float* pDepthRow1{ pDepthRow0 + m_Width };
+			const SimdFloat storedZ{ SimdFloat::LoadBlock(pDepthRow0, pDepthRow1) };
+
+			if (depthPrePassed)
+			{
+				visible = coverage & EqualMask(bufferValueZ, storedZ);
+			}
+			else
+			{
+				visible = acceptAll ? coverage : coverage & LessEqualMask(bufferValueZ, storedZ);
+			}
+			if (visible != 0 && !depthPrePassed)
+			{
+				Select(visible, bufferValueZ, storedZ).StoreBlock(pDepthRow0, pDepthRow1);
+			}
+		}
+		else
+		{
+			for (int lanes{ coverage }; lanes != 0; lanes &= lanes - 1)
+			{
+				const int lane{ std::countr_zero(unsigned(lanes)) };
+				float& storedZ{ m_pDepthBufferPixels[pixelIndex + (lane & 3) + (lane >> 2) * m_Width] };
+				if (depthPrePassed)
+				{
+					if (depthLanes[lane] == storedZ)
+					{
+						visible |= 1 << lane;
+					}
+				}
+				else if (acceptAll || depthLanes[lane] <= storedZ)
+				{
+					storedZ = depthLanes[lane];
+					visible |= 1 << lane;
+				}
+			}
+		}
+		stats.pixelsTested += std::popcount(unsigned(coverage));
+		if (visible == 0)
+			return false;
+
+		stats.pixelsPassedDepth += std::popcount(unsigned(visible));
+		if (m_Settings.shadingPath == ShadingPath::VisibilityBuffer)
+		{
+			for (int lanes{ visible }; lanes != 0; lanes &= lanes - 1)
+			{
+				const int lane{ std::countr_zero(unsigned(lanes)) };
+				m_TriangleIdBuffer[pixelIndex + (lane & 3) + (lane >> 2) * m_Width] = triangleId;
+			}
+		}
+		else
+		{
+			stats.pixelsShaded += std::popcount(unsigned(visible));
+			ShadeBlock(triangle, pixelIndex, visible, x, y, depthLanes);
+		}
+
+		return !depthPrePassed;
+	};
+
+	const int64_t stepXBC{ triangle.edgeBC.a * SUB_PIXEL_SCALE * SIMD_BLOCK_WIDTH };
+	const int64_t stepXCA{ triangle.edgeCA.a * SUB_PIXEL_SCALE * SIMD_BLOCK_WIDTH };
+	const int64_t stepXAB{ triangle.edgeAB.a * SUB_PIXEL_SCALE * SIMD_BLOCK_WIDTH };
+	const int64_t stepYBC{ triangle.edgeBC.b * SUB_PIXEL_SCALE * SIMD_BLOCK_HEIGHT };
+	const int64_t stepYCA{ triangle.edgeCA.b * SUB_PIXEL_SCALE * SIMD_BLOCK_HEIGHT };
+	const int64_t stepYAB{ triangle.edgeAB.b * SUB_PIXEL_SCALE * SIMD_BLOCK_HEIGHT };
+
+	const int64_t cellStepXBC{ triangle.edgeBC.a * SUB_PIXEL_SCALE * m_HiZCellSize };
+	const int64_t cellStepXCA{ triangle.edgeCA.a * SUB_PIXEL_SCALE * m_HiZCellSize };
+	const int64_t cellStepXAB{ triangle.edgeAB.a * SUB_PIXEL_SCALE * m_HiZCellSize };
+	const int64_t cellStepYBC{ triangle.edgeBC.b * SUB_PIXEL_SCALE * m_HiZCellSize };
+	const int64_t cellStepYCA{ triangle.edgeCA.b * SUB_PIXEL_SCALE * m_HiZCellSize };
+	const int64_t cellStepYAB{ triangle.edgeAB.b * SUB_PIXEL_SCALE * m_HiZCellSize };
+
+	//Walk the hierarchical depth cells, then the 4x2 blocks inside them
+	const int cellMinX{ minX - minX % m_HiZCellSize };
+	const int cellMinY{ minY - minY % m_HiZCellSize };
+
+	//Edge values at lane 0 of the first cell, stepped with additions only from here on
+	const int64_t startX{ int64_t(cellMinX) * SUB_PIXEL_SCALE + SUB_PIXEL_HALF };
+	const int64_t startY{ int64_t(cellMinY) * SUB_PIXEL_SCALE + SUB_PIXEL_HALF };
+	int64_t cellRowBC{ triangle.edgeBC.Evaluate(startX, startY) };
+	int64_t cellRowCA{ triangle.edgeCA.Evaluate(startX, startY) };
+	int64_t cellRowAB{ triangle.edgeAB.Evaluate(startX, startY) };
+
+	bool depthChanged{ false };
+
+	//RENDER LOGIC
+	for (int cy{ cellMinY }; cy < maxY; cy += m_HiZCellSize, cellRowBC += cellStepYBC, cellRowCA += cellStepYCA, cellRowAB += cellStepYAB)
+	{
+		int64_t cellBC{ cellRowBC };
+		int64_t cellCA{ cellRowCA };
+		int64_t cellAB{ cellRowAB };
+
+		for (int cx{ cellMinX }; cx < maxX; cx += m_HiZCellSize, cellBC += cellStepXBC, cellCA += cellStepXCA, cellAB += cellStepXAB)
+		{
+			DepthBounds& cellBounds{ m_HiZCells[(cy / m_HiZCellSize) * m_NrHiZCellsX + cx / m_HiZCellSize] };
+
+			//Everything in this cell is already closer than the triangle
+			if (triangle.minZ > cellBounds.max)
+				continue;
+
+			//Everything in this cell is further away than the triangle
+			const bool acceptAll{ triangle.maxZ <= cellBounds.min && !depthPrePassed };
+
+			const int cellMaxX{ std::min(cx + m_HiZCellSize, maxX) };
+			const int cellMaxY{ std::min(cy + m_HiZCellSize, maxY) };
+			bool cellChanged{ false };
+
+			int64_t rowBC{ cellBC };
+			int64_t rowCA{ cellCA };
+			int64_t rowAB{ cellAB };
+			for (int by{ cy }; by < cellMaxY; by += SIMD_BLOCK_HEIGHT, rowBC += stepYBC, rowCA += stepYCA, rowAB += stepYAB)
+			{
+				int64_t edgeBC{ rowBC };
+				int64_t edgeCA{ rowCA };
+				int64_t edgeAB{ rowAB };
+				for (int bx{ cx }; bx < cellMaxX; bx += SIMD_BLOCK_WIDTH, edgeBC += stepXBC, edgeCA += stepXCA, edgeAB += stepXAB)
+				{
+					cellChanged |= rasterizeBlock(bx, by, edgeBC, edgeCA, edgeAB, acceptAll);
+				}
+			}
+
+			if (cellChanged)
+			{
+				UpdateHiZCell(cx, cy);
+				depthChanged = true;
+			}
+		}
+	}
+
+	return depthChanged;
+}
+
+void SoftwareRenderer::ShadeBlock(const TriangleSetup& triangle, int pixelIndex, int visible, const SimdFloat& x, const SimdFloat& y, const float* pDepthLanes)
+{
+	TIME_STAGE(m_StageTimers, PipelineStage::Shade);
+	//Perspective correct interpolation of all attributes for the whole block, two multiply-adds and a multiply each
+	const SimdFloat interpolatedW{ Reciprocal(DepthRasterizer::EvaluatePlane(triangle.inverseW, x, y)) }; // interpolated depth (linear)
+	auto interpolate = [&](const AttributePlane& plane)
+	{
+		return DepthRasterizer::EvaluatePlane(plane, x, y) * interpolatedW;
+	};
+
+	const SimdFloat u{ interpolate(triangle.attributes[AttributeU]) };
+	const SimdFloat v{ interpolate(triangle.attributes[AttributeV]) };
+
+	SimdFloat normalX{ interpolate(triangle.attributes[AttributeNormalX]) };
+	SimdFloat normalY{ interpolate(triangle.attributes[AttributeNormalY]) };
+	SimdFloat normalZ{ interpolate(triangle.attributes[AttributeNormalZ]) };
+	Normalize(normalX, normalY, normalZ);
+
+	SimdFloat tangentX{ interpolate(triangle.attributes[AttributeTangentX]) };
+	SimdFloat tangentY{ interpolate(triangle.attributes[AttributeTangentY]) };
+	SimdFloat tangentZ{ interpolate(triangle.attributes[AttributeTangentZ]) };
+	Normalize(tangentX, tangentY, tangentZ);
+
+	SimdFloat viewDirectionX{ interpolate(triangle.attributes[AttributeViewDirectionX]) };
+	SimdFloat viewDirectionY{ interpolate(triangle.attributes[AttributeViewDirectionY]) };
+	SimdFloat viewDirectionZ{ interpolate(triangle.attributes[AttributeViewDirectionZ]) };
+	Normalize(viewDirectionX, viewDirectionY, viewDirectionZ);
+
+	float uLanes[SIMD_WIDTH], vLanes[SIMD_WIDTH];
+	float normalLanes[3][SIMD_WIDTH], tangentLanes[3][SIMD_WIDTH], viewDirectionLanes[3][SIMD_WIDTH];
+	u.Store(uLanes);
+	v.Store(vLanes);
+	normalX.Store(normalLanes[0]);
+	normalY.Store(normalLanes[1]);
+	normalZ.Store(normalLanes[2]);
+	tangentX.Store(tangentLanes[0]);
+	tangentY.Store(tangentLanes[1]);
+	tangentZ.Store(tangentLanes[2]);
+	viewDirectionX.Store(viewDirectionLanes[0]);
+	viewDirectionY.Store(viewDirectionLanes[1]);
+	viewDirectionZ.Store(viewDirectionLanes[2]);
+
+	//Texture gradients per 2x2 quad, lanes {0, 1, 4, 5} and {2, 3, 6, 7}.
+	//The planes also hold outside the triangle, so lanes that are not visible still give the differences.
+	TextureSampling::QuadGradients quadGradients[SIMD_BLOCK_WIDTH / 2]{};
+	for (int quad{}; quad < SIMD_BLOCK_WIDTH / 2; ++quad)
+	{
+		const int lane{ quad * 2 };
+		quadGradients[quad].dudx = uLanes[lane + 1] - uLanes[lane];
+		quadGradients[quad].dvdx = vLanes[lane + 1] - vLanes[lane];
+		quadGradients[quad].dudy = uLanes[lane + SIMD_BLOCK_WIDTH] - uLanes[lane];
+		quadGradients[quad].dvdy = vLanes[lane + SIMD_BLOCK_WIDTH] - vLanes[lane];
+	}
+
+	//The whole material once for the whole block, lambert and phong factors folded into the decode
+	float materialLanes[8][SIMD_WIDTH];
+	if (!m_Settings.depthVisualization)
+	{
+		MaterialTexture::Block material;
+		const MaterialTexture::Scales scales{ LIGHT_INTENSITY / PI, 1.f, SHININESS };
+		m_pScene->pMaterialTxt->SampleBlock(u, v, quadGradients, visible, m_Settings.samplerState, scales, material);
+		for (int channel{}; channel < 3; ++channel)
+		{
+			material.albedo[channel].Store(materialLanes[channel]);
+			material.normal[channel].Store(materialLanes[3 + channel]);
+		}
+		material.specular.Store(materialLanes[6]);
+		material.gloss.Store(materialLanes[7]);
+	}
+
+	//Shade the visible lanes only, the block is packed and written at once afterwards
+	float redLanes[SIMD_WIDTH]{}, greenLanes[SIMD_WIDTH]{}, blueLanes[SIMD_WIDTH]{};
+	for (int lanes{ visible }; lanes != 0; lanes &= lanes - 1)
+	{
+		const int lane{ std::countr_zero(unsigned(lanes)) };
+		ColorRGB finalColor{ 0.0f, 0.0f, 0.0f };
+
+		if (m_Settings.depthVisualization)
+		{
+			const float min{ 0.995f };
+			const float max{ 1.0f };
+			float depthColor = (Clamp(pDepthLanes[lane], min, max) - min) * (1.0f / (max - min));
+			finalColor = { depthColor, depthColor, depthColor };
+		}
+		else
+		{
+			Vertex_Out vertexOut{};
+			vertexOut.uv = { uLanes[lane], vLanes[lane] };
+			vertexOut.normal = { normalLanes[0][lane], normalLanes[1][lane], normalLanes[2][lane] };
+			vertexOut.tangent = { tangentLanes[0][lane], tangentLanes[1][lane], tangentLanes[2][lane] };
+			vertexOut.viewDirection = { viewDirectionLanes[0][lane], viewDirectionLanes[1][lane], viewDirectionLanes[2][lane] };
+
+			const MaterialSample material{
+				ColorRGB{ materialLanes[0][lane], materialLanes[1][lane], materialLanes[2][lane] },
+				Vector3{ materialLanes[3][lane], materialLanes[4][lane], materialLanes[5][lane] },
+				materialLanes[6][lane],
+				materialLanes[7][lane] };
+
+			finalColor = PixelShading(vertexOut, material);
+		}
+
+		redLanes[lane] = finalColor.r;
+		greenLanes[lane] = finalColor.g;
+		blueLanes[lane] = finalColor.b;
+	}
+
+	if (m_Settings.overdrawVisualization)
+	{
+		for (int lanes{ visible }; lanes != 0; lanes &= lanes - 1)
+		{
+			const int lane{ std::countr_zero(unsigned(lanes)) };
+			++m_OverdrawBuffer[pixelIndex + (lane & 3) + (lane >> 2) * m_Width];
+		}
+	}
+
+	//Update Color in Buffer
+	m_ColorFormat.WriteBlock(&m_pColorPixels[pixelIndex], m_Width, visible,
+		SimdFloat::Load(redLanes), SimdFloat::Load(greenLanes), SimdFloat::Load(blueLanes));
+}
+
+void SoftwareRenderer::ResolveTile(int tileIndex, RasterStats& stats)
+{
+	PROFILE_ZONE("ResolveTile");
+	TIME_STAGE(m_StageTimers, PipelineStage::Resolve);
+	//Nothing was rasterized here, the depth of this tile is stale
+	if (!m_TileDepthCleared[tileIndex])
+		return;
+
+	const int tileMinX{ (tileIndex % m_NrTilesX) * m_TileSize };
+	const int tileMinY{ (tileIndex / m_NrTilesX) * m_TileSize };
+	const int tileMaxX{ std::min(tileMinX + m_TileSize, m_Width) };
+	const int tileMaxY{ std::min(tileMinY + m_TileSize, m_Height) };
+
+	for (int by{ tileMinY }; by < tileMaxY; by += SIMD_BLOCK_HEIGHT)
+	{
+		for (int bx{ tileMinX }; bx < tileMaxX; bx += SIMD_BLOCK_WIDTH)
+		{
+			const int pixelIndex{ bx + (by * m_Width) };
+
+			//Lanes that hold a triangle, untouched pixels still have the cleared depth
+			float depthLanes[SIMD_WIDTH]{};
+			uint32_t idLanes[SIMD_WIDTH]{};
+			int pending{};
+			for (int lane{}; lane < SIMD_WIDTH; ++lane)
+			{
+				const int px{ bx + (lane & 3) };
+				const int py{ by + (lane >> 2) };
+				if (px >= tileMaxX || py >= tileMaxY)
+					continue;
+
+				const int index{ px + (py * m_Width) };
+				depthLanes[lane] = m_pDepthBufferPixels[index];
+				if (depthLanes[lane] == FLT_MAX)
+					continue;
+
+				idLanes[lane] = m_TriangleIdBuffer[index];
+				pending |= 1 << lane;
+			}
+
+			//Shade the block once per distinct triangle, usually one or two
+			while (pending != 0)
+			{
+				const uint32_t triangleId{ idLanes[std::countr_zero(unsigned(pending))] };
+				int lanes{};
+				for (int lane{}; lane < SIMD_WIDTH; ++lane)
+				{
+					if ((pending >> lane & 1) && idLanes[lane] == triangleId)
+					{
+						lanes |= 1 << lane;
+					}
+				}
+				pending &= ~lanes;
+
+				//Same plane coordinates the raster pass had for these pixels
+				const TriangleSetup& triangle{ GetTriangle(triangleId) };
+				SimdFloat x, y;
+				DepthRasterizer::GetBlockCoordinates(triangle, bx, by, x, y);
+
+				stats.pixelsShaded += std::popcount(unsigned(lanes));
+				ShadeBlock(triangle, pixelIndex, lanes, x, y, depthLanes);
+			}
+		}
+	}
+}
+
+const TriangleSetup& SoftwareRenderer::GetTriangle(uint32_t triangleId) const
+{
+	//Few jobs, a search over their first ids is cheap
+	const auto it{ std::upper_bound(m_TriangleIdOffsets.begin(), m_TriangleIdOffsets.end(), triangleId) };
+	const size_t job{ static_cast<size_t>(it - m_TriangleIdOffsets.begin()) - 1 };
+	return m_BinnedTriangles[job].pTriangles[triangleId - m_TriangleIdOffsets[job]];
+}
+
+bool SoftwareRenderer::HasBinnedTriangles(int tileIndex) const
+{
+	for (const BinnedTriangles& bins : m_BinnedTriangles)
+	{
+		if (bins.pTileOffsets[tileIndex] != bins.pTileOffsets[tileIndex + 1])
+			return true;
+	}
+	return false;
+}
+
+void SoftwareRenderer::ClearTileColor(int tileIndex)
+{
+	const int tileMinX{ (tileIndex % m_NrTilesX) * m_TileSize };
+	const int tileMinY{ (tileIndex / m_NrTilesX) * m_TileSize };
+	const int tileMaxX{ std::min(tileMinX + m_TileSize, m_Width) };
+	const int tileMaxY{ std::min(tileMinY + m_TileSize, m_Height) };
+
+	for (int py{ tileMinY }; py < tileMaxY; ++py)
+	{
+		std::fill_n(&m_pColorPixels[tileMinX + (py * m_Width)], tileMaxX - tileMinX, m_ClearColor);
+	}
+
+	if (m_Settings.overdrawVisualization)
+	{
+		for (int py{ tileMinY }; py < tileMaxY; ++py)
+		{
+			std::fill_n(&m_OverdrawBuffer[tileMinX + (py * m_Width)], tileMaxX - tileMinX, uint16_t{ 0 });
+		}
+	}
+}
+
+void SoftwareRenderer::VisualizeOverdrawTile(int tileIndex)
+{
+	const int tileMinX{ (tileIndex % m_NrTilesX) * m_TileSize };
+	const int tileMinY{ (tileIndex / m_NrTilesX) * m_TileSize };
+	const int tileMaxX{ std::min(tileMinX + m_TileSize, m_Width) };
+	const int tileMaxY{ std::min(tileMinY + m_TileSize, m_Height) };
+
+	//Heat map: never shaded keeps the clear color, then blue (once) over green and yellow to red (8 times or more)
+	const int maxOverdraw{ 8 };
+	uint32_t heatColors[maxOverdraw + 1]{ m_ClearColor };
+	for (int count{ 1 }; count <= maxOverdraw; ++count)
+	{
+		const float heat{ float(count - 1) / (maxOverdraw - 1) };
+		const ColorRGB color{ heat < .5f ? ColorRGB{ 0.f, heat * 2.f, 1.f - heat * 2.f } : ColorRGB{ (heat - .5f) * 2.f, 1.f - (heat - .5f) * 2.f, 0.f } };
+		heatColors[count] = m_ColorFormat.Pack(color);
+	}
+
+	for (int py{ tileMinY }; py < tileMaxY; ++py)
+	{
+		for (int px{ tileMinX }; px < tileMaxX; ++px)
+		{
+			const int index{ px + (py * m_Width) };
+			m_pColorPixels[index] = heatColors[std::min<int>(m_OverdrawBuffer[index], maxOverdraw)];
+		}
+	}
+}
+
+void SoftwareRenderer::ClearTileDepth(int tileIndex)
+{
+	//The first pass that rasterizes into the tile clears it, later passes keep its depth
+	if (m_TileDepthCleared[tileIndex])
+		return;
+
+	m_TileDepthCleared[tileIndex] = 1;
+
+	const int tileMinX{ (tileIndex % m_NrTilesX) * m_TileSize };
+	const int tileMinY{ (tileIndex / m_NrTilesX) * m_TileSize };
+	const int tileMaxX{ std::min(tileMinX + m_TileSize, m_Width) };
+	const int tileMaxY{ std::min(tileMinY + m_TileSize, m_Height) };
+
+	for (int py{ tileMinY }; py < tileMaxY; ++py)
+	{
+		std::fill_n(&m_pDepthBufferPixels[tileMinX + (py * m_Width)], tileMaxX - tileMinX, FLT_MAX);
+	}
+
+	for (int cellY{ tileMinY / m_HiZCellSize }; cellY * m_HiZCellSize < tileMaxY; ++cellY)
+	{
+		std::fill_n(&m_HiZCells[cellY * m_NrHiZCellsX + tileMinX / m_HiZCellSize], (tileMaxX - tileMinX + m_HiZCellSize - 1) / m_HiZCellSize, DepthBounds{ FLT_MAX, FLT_MAX });
+	}
+	m_HiZTileMax[tileIndex] = FLT_MAX;
+}
+
+void SoftwareRenderer::UpdateHiZCell(int cellX, int cellY)
+{
+	//Exact bounds of the cell, its depth values are still in cache after the writes
+	DepthBounds bounds{ FLT_MAX, 0.f };
+
+	const int maxX{ std::min(cellX + m_HiZCellSize, m_Width) };
+	const int maxY{ std::min(cellY + m_HiZCellSize, m_Height) };
+	for (int py{ cellY }; py < maxY; ++py)
+	{
+		for (int px{ cellX }; px < maxX; ++px)
+		{
+			const float depth{ m_pDepthBufferPixels[px + (py * m_Width)] };
+			bounds.min = std::min(bounds.min, depth);
+			bounds.max = std::max(bounds.max, depth);
+		}
+	}
+
+	m_HiZCells[(cellY / m_HiZCellSize) * m_NrHiZCellsX + cellX / m_HiZCellSize] = bounds;
+}
+
+void SoftwareRenderer::UpdateHiZTile(int tileIndex)
+{
+	const int tileMinX{ (tileIndex % m_NrTilesX) * m_TileSize };
+	const int tileMinY{ (tileIndex / m_NrTilesX) * m_TileSize };
+	const int tileMaxX{ std::min(tileMinX + m_TileSize, m_Width) };
+	const int tileMaxY{ std::min(tileMinY + m_TileSize, m_Height) };
+
+	float tileMax{ 0.f };
+	for (int cellY{ tileMinY / m_HiZCellSize }; cellY * m_HiZCellSize < tileMaxY; ++cellY)
+	{
+		for (int cellX{ tileMinX / m_HiZCellSize }; cellX * m_HiZCellSize < tileMaxX; ++cellX)
+		{
+			tileMax = std::max(tileMax, m_HiZCells[cellY * m_NrHiZCellsX + cellX].max);
+		}
+	}
+	m_HiZTileMax[tileIndex] = tileMax;
+}
+
+void SoftwareRenderer::VertexTransformationFunctionW4(std::vector<MeshRasterizer>& meshes, const Camera& camera)
+{
+	PROFILE_ZONE("VertexTransformationFunctionW4");
+	for (MeshRasterizer& mesh : meshes)
+	{
+		const Matrix matrix = mesh.worldMatrix * (camera.viewMatrix * camera.projectionMatrix);
+
+		TransformedVertices& vertices{ mesh.vertices_out };
+		vertices.Resize(mesh.vertices.size());
+
+		//Chunks are whole SIMD batches, every worker writes its own part of the streams
+		const size_t nrVertices{ mesh.vertices.size() };
+		const uint32_t nrChunks{ static_cast<uint32_t>((nrVertices + m_VertexChunkSize - 1) / m_VertexChunkSize) };
+		m_ThreadPool.ParallelFor(nrChunks, [&](uint32_t chunk, uint32_t)
+			{
+				TIME_STAGE(m_StageTimers, PipelineStage::Transform);
+				const size_t first{ size_t(chunk) * m_VertexChunkSize };
+				TransformVertexChunk(mesh, matrix, camera.origin, first, std::min(first + m_VertexChunkSize, nrVertices));
+			});
+	}
+}
+
+void SoftwareRenderer::TransformVertexChunk(MeshRasterizer& mesh, const Matrix& worldViewProjection, const Vector3& cameraOrigin, size_t first, size_t last) const
+{
+	PROFILE_ZONE("TransformVertexChunk");
+	TransformedVertices& vertices{ mesh.vertices_out };
+	const size_t pitch{ vertices.GetPitch() };
+	float* pClipX{ vertices.GetStream(TransformedVertices::ClipX) };
+	float* pClipY{ vertices.GetStream(TransformedVertices::ClipY) };
+	float* pClipZ{ vertices.GetStream(TransformedVertices::ClipZ) };
+	float* pClipW{ vertices.GetStream(TransformedVertices::ClipW) };
+	float* pScreenX{ vertices.GetStream(TransformedVertices::ScreenX) };
+	float* pScreenY{ vertices.GetStream(TransformedVertices::ScreenY) };
+	float* pScreenZ{ vertices.GetStream(TransformedVertices::ScreenZ) };
+	float* pAttributes{ vertices.GetStream(TransformedVertices::FirstAttribute) };
+	int32_t* pOutcodes{ vertices.GetOutcodes() };
+
+	//Both matrices are broadcast once, every batch then only multiplies and adds
+	struct SimdMatrix
+	{
+		SimdFloat m[4][4];
+	};
+	auto loadMatrix = [](const Matrix& matrix)
+	{
+		SimdMatrix result;
+		for (int row{}; row < 4; ++row)
+		{
+			for (int column{}; column < 4; ++column)
+			{
+				result.m[row][column] = SimdFloat{ matrix[row][column] };
+			}
+		}
+		return result;
+	};
+	const SimdMatrix world{ loadMatrix(mesh.worldMatrix) };
+	const SimdMatrix clip{ loadMatrix(worldViewProjection) };
+
+	//Same operation order as Matrix::TransformPoint/TransformVector and Vector3::Normalized
+	auto transform = [](const SimdMatrix& matrix, int column, const SimdFloat& x, const SimdFloat& y, const SimdFloat& z)
+	{
+		return matrix.m[0][column] * x + matrix.m[1][column] * y + matrix.m[2][column] * z;
+	};
+	auto normalize = [](SimdFloat& x, SimdFloat& y, SimdFloat& z)
+	{
+		const SimdFloat length{ Sqrt(x * x + y * y + z * z) };
+		x = x / length;
+		y = y / length;
+		z = z / length;
+	};
+
+	const SimdFloat one{ 1.f };
+	const SimdFloat two{ 2.f };
+	const SimdFloat width{ float(m_Width) };
+	const SimdFloat height{ float(m_Height) };
+	const SimdFloat originX{ cameraOrigin.x };
+	const SimdFloat originY{ cameraOrigin.y };
+	const SimdFloat originZ{ cameraOrigin.z };
+
+	//Guard band in NDC units, see BinTriangles
+	const float guardBandX{ 2 * GUARD_BAND_COORDINATE / m_Width - 1 };
+	const float guardBandY{ 2 * GUARD_BAND_COORDINATE / m_Height - 1 };
+
+	for (size_t batch{ first }; batch < last; batch += SIMD_WIDTH)
+	{
+		//Gather the input lanes, the last batch repeats the final vertex into the stream padding
+		float lanes[11][SIMD_WIDTH];
+		for (int lane{}; lane < SIMD_WIDTH; ++lane)
+		{
+			const Vertex& vertex{ mesh.vertices[std::min(batch + lane, last - 1)] };
+			const float components[11]{ vertex.position.x, vertex.position.y, vertex.position.z,
+				vertex.uv.x, vertex.uv.y,
+				vertex.normal.x, vertex.normal.y, vertex.normal.z,
+				vertex.tangent.x, vertex.tangent.y, vertex.tangent.z };
+			for (int component{}; component < 11; ++component)
+			{
+				lanes[component][lane] = components[component];
+			}
+		}
+		const SimdFloat positionX{ SimdFloat::Load(lanes[0]) };
+		const SimdFloat positionY{ SimdFloat::Load(lanes[1]) };
+		const SimdFloat positionZ{ SimdFloat::Load(lanes[2]) };
+
+		//Projection stage, the clipper still needs clip space
+		const SimdFloat clipX{ transform(clip, 0, positionX, positionY, positionZ) + clip.m[3][0] };
+		const SimdFloat clipY{ transform(clip, 1, positionX, positionY, positionZ) + clip.m[3][1] };
+		const SimdFloat clipZ{ transform(clip, 2, positionX, positionY, positionZ) + clip.m[3][2] };
+		const SimdFloat clipW{ transform(clip, 3, positionX, positionY, positionZ) + clip.m[3][3] };
+		clipX.Store(pClipX + batch);
+		clipY.Store(pClipY + batch);
+		clipZ.Store(pClipZ + batch);
+		clipW.Store(pClipW + batch);
+
+		//Every unique vertex is projected once, triangles that need no clipping only read these.
+		//Vertices behind the camera get a meaningless screen position, their triangles always go through the clipper.
+		((clipX / clipW + one) / two * width).Store(pScreenX + batch);
+		((one - clipY / clipW) / two * height).Store(pScreenY + batch);
+		(clipZ / clipW).Store(pScreenZ + batch);
+
+		//convert normal and tangent to worldspace, for rotation -> normalize them after
+		const SimdFloat modelNormalX{ SimdFloat::Load(lanes[5]) };
+		const SimdFloat modelNormalY{ SimdFloat::Load(lanes[6]) };
+		const SimdFloat modelNormalZ{ SimdFloat::Load(lanes[7]) };
+		SimdFloat normalX{ transform(world, 0, modelNormalX, modelNormalY, modelNormalZ) };
+		SimdFloat normalY{ transform(world, 1, modelNormalX, modelNormalY, modelNormalZ) };
+		SimdFloat normalZ{ transform(world, 2, modelNormalX, modelNormalY, modelNormalZ) };
+		normalize(normalX, normalY, normalZ);
+
+		const SimdFloat modelTangentX{ SimdFloat::Load(lanes[8]) };
+		const SimdFloat modelTangentY{ SimdFloat::Load(lanes[9]) };
+		const SimdFloat modelTangentZ{ SimdFloat::Load(lanes[10]) };
+		SimdFloat tangentX{ transform(world, 0, modelTangentX, modelTangentY, modelTangentZ) };
+		SimdFloat tangentY{ transform(world, 1, modelTangentX, modelTangentY, modelTangentZ) };
+		SimdFloat tangentZ{ transform(world, 2, modelTangentX, modelTangentY, modelTangentZ) };
+		normalize(tangentX, tangentY, tangentZ);
+
+		// Calculate vert world position, for viewDirection
+		const SimdFloat worldX{ transform(world, 0, positionX, positionY, positionZ) + world.m[3][0] };
+		const SimdFloat worldY{ transform(world, 1, positionX, positionY, positionZ) + world.m[3][1] };
+		const SimdFloat worldZ{ transform(world, 2, positionX, positionY, positionZ) + world.m[3][2] };
+
+		const SimdFloat attributes[NrVertexAttributes]{ SimdFloat::Load(lanes[3]), SimdFloat::Load(lanes[4]),
+			normalX, normalY, normalZ,
+			tangentX, tangentY, tangentZ,
+			originX - worldX, originY - worldY, originZ - worldZ };
+		for (int attribute{}; attribute < NrVertexAttributes; ++attribute)
+		{
+			attributes[attribute].Store(pAttributes + attribute * pitch + batch);
+		}
+
+		//Outcodes from the stored clip positions, scalar is as fast as masking 10 planes per lane
+		const size_t batchLast{ std::min(batch + SIMD_WIDTH, last) };
+		for (size_t index{ batch }; index < batchLast; ++index)
+		{
+			pOutcodes[index] = GetOutcode(Vector4{ pClipX[index], pClipY[index], pClipZ[index], pClipW[index] }, guardBandX, guardBandY);
+		}
+	}
+}
+
+ColorRGB SoftwareRenderer::PixelShading(const Vertex_Out& v, const MaterialSample& material) const
+{
+	ColorRGB finalColor{};
+
+	//Base color, already times the light intensity over pi
+	const ColorRGB& lambert{ material.lambert };
+
+	//Normals
+	const Vector3 binormal{ Vector3::Cross(v.normal, v.tangent) };
+	const Matrix tangentSpaceAxis{ v.tangent, binormal, v.normal, Vector3::Zero };
+	const Vector3 normalTangentSpace{ tangentSpaceAxis.TransformVector(material.normal) };
+
+	//Change Normals
+	Vector3 typeOfNormals{};
+	if (m_Settings.normalMapping)
+	{
+		typeOfNormals = normalTangentSpace;
+	}
+	else
+	{
+		typeOfNormals = v.normal;
+	}
+	const float observedArea{ Vector3::Dot(typeOfNormals, -LIGHT_DIRECTION) };
+
+	if (observedArea < 0.0f)
+		return {};
+
+	//Phong specular
+	const ColorRGB ambient{ .025f, .025f, .025f };
+
+	const Vector3 reflection{ LIGHT_DIRECTION - (2.0f * Vector3::Dot(typeOfNormals, LIGHT_DIRECTION) * typeOfNormals) };
+	float dotReflectionViewDir{ std::max(0.f, Vector3::Dot(reflection, v.viewDirection)) }; // so dot is never negative
+	const float phongValue{ material.specular * powf(dotReflectionViewDir, material.phongExponent) };
+	const ColorRGB phong{ phongValue, phongValue, phongValue };
+
+
+	switch (m_Settings.lightMode)
+	{
+	case LightMode::Combined:
+		finalColor = (lambert + phong + ambient) * observedArea;
+		break;
+	case LightMode::Diffuse:
+		finalColor = lambert * observedArea;
+		break;
+	case LightMode::Specular:
+		finalColor = phong;
+		break;
+	case LightMode::ObservedArea:
+		finalColor = { observedArea, observedArea, observedArea };
+		break;
+	}
+	
+	return finalColor;
+}
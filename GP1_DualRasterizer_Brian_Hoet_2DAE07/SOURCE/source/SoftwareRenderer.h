@@ -0,0 +1,212 @@
+#pragma once
+#include "Camera.h"
+#include "DataTypes.h"
+#include "TransformedVertices.h"
+#include "ThreadPool.h"
+#include "FrameArena.h"
+#include "PixelWriter.h"
+#include "StageTimers.h"
+#include "SamplerState.h"
+
+//Standard includes
+#include <vector>
+
+class MaterialTexture;
+
+struct MeshRasterizer
+{
+	std::vector<Vertex> vertices{};
+	std::vector<uint32_t> indices{};
+	PrimitiveTopology primitiveTopology{ PrimitiveTopology::TriangleStrip };
+
+	TransformedVertices vertices_out{};
+	Matrix worldMatrix{};
+};
+
+//Everything the software renderer draws, owned by the caller.
+//The meshes are not const, the vertex stage keeps its output in them.
+struct SoftwareScene
+{
+	std::vector<MeshRasterizer> meshes{};
+
+	const MaterialTexture* pMaterialTxt{};
+};
+
+//Caller owned buffers a frame is rendered into, width * height pixels with rows width pixels apart
+struct SoftwareRenderTarget
+{
+	uint32_t* pColor{};
+	PixelWriter colorFormat{ PixelWriter::CreateRGBA8() };
+	float* pDepth{}; //optional, gets the final depth with FLT_MAX where nothing was drawn
+};
+
+//The CPU rasterizer on its own: no window, console or D3D device, so it can also run headless.
+//Renders one frame of a scene into caller owned buffers, without copies.
+class SoftwareRenderer final
+{
+public:
+	//Cycles in the same order as the DirectX effect so both paths stay in sync
+	enum class CullMode
+	{
+		Back,
+		None,
+		Front
+	};
+
+	enum class LightMode
+	{
+		Combined,
+		Diffuse,
+		Specular,
+		ObservedArea
+	};
+
+	enum class ShadingPath
+	{
+		Forward, //shade every fragment that passes the depth test
+		DepthPrePass, //depth-only pass first, then shade the fragments that match the final depth
+		VisibilityBuffer //raster triangle ids only, shade each visible pixel once afterwards
+	};
+
+	struct Settings
+	{
+		CullMode cullMode{ CullMode::Back };
+		LightMode lightMode{ LightMode::Combined };
+		ShadingPath shadingPath{ ShadingPath::Forward };
+		bool normalMapping{ true };
+		SamplerState samplerState{}; //for the material texture, mip levels are picked per 2x2 quad of a shaded block
+		bool depthVisualization{ false };
+		bool boundingBoxVisualization{ false };
+		bool overdrawVisualization{ false }; //colors every pixel by how many times it was shaded
+		ColorRGB clearColor{ .39f, .39f, .39f };
+	};
+
+	//Counters of one frame. Culling is counted per set up triangle, so a clipped triangle can count more than once.
+	//Rasterized and depth culled triangles count once per tile they overlap,
+	//pixels are counted in the shading raster pass, a depth pre-pass is not included.
+	struct RasterStats
+	{
+		uint64_t trianglesSubmitted{};
+		uint64_t trianglesFrustumCulled{};
+		uint64_t trianglesBackfaceCulled{};
+		uint64_t trianglesZeroAreaCulled{}; //degenerate, or covering no pixel center
+		uint64_t trianglesDepthCulled{}; //rejected whole by the hierarchical depth of a tile
+		uint64_t trianglesRasterized{};
+		uint64_t pixelsTested{};
+		uint64_t pixelsPassedDepth{};
+		uint64_t pixelsShaded{};
+
+		RasterStats& operator+=(const RasterStats& other);
+	};
+
+	SoftwareRenderer(int width, int height, uint32_t nrThreads = 0); //0 = one thread per hardware core
+	~SoftwareRenderer() = default;
+
+	SoftwareRenderer(const SoftwareRenderer&) = delete;
+	SoftwareRenderer(SoftwareRenderer&&) noexcept = delete;
+	SoftwareRenderer& operator=(const SoftwareRenderer&) = delete;
+	SoftwareRenderer& operator=(SoftwareRenderer&&) noexcept = delete;
+
+	//The camera needs its view and projection matrices calculated
+	void Render(SoftwareScene& scene, const Camera& camera, const SoftwareRenderTarget& target);
+
+	Settings& GetSettings() { return m_Settings; }
+	const Settings& GetSettings() const { return m_Settings; }
+	const RasterStats& GetRasterStats() const { return m_RasterStats; }
+	//Wall clock time of the last Render
+	double GetFrameMilliseconds() const { return m_FrameMilliseconds; }
+	//Per stage thread time of the last Render, restarted by every Render
+	StageTimers& GetStageTimers() { return m_StageTimers; }
+	const StageTimers& GetStageTimers() const { return m_StageTimers; }
+	int GetWidth() const { return m_Width; }
+	int GetHeight() const { return m_Height; }
+	uint32_t GetNrThreads() const { return m_ThreadPool.GetNrThreads(); }
+
+private:
+	int m_Width{};
+	int m_Height{};
+	Settings m_Settings{};
+	double m_FrameMilliseconds{};
+	RasterStats m_RasterStats{};
+
+	//Only valid during Render
+	SoftwareScene* m_pScene{};
+	uint32_t* m_pColorPixels{};
+	PixelWriter m_ColorFormat{};
+	float* m_pDepthBufferPixels{};
+	bool m_ClearUntouchedDepth{ false }; //a caller depth buffer is handed back complete
+
+	std::vector<float> m_DepthBuffer; //used when the target has no depth buffer
+	std::vector<uint32_t> m_TriangleIdBuffer; //visibility buffer, only valid where the depth buffer was written
+	std::vector<uint16_t> m_OverdrawBuffer; //times every pixel was shaded, only used by the overdraw view
+
+	//Tiles
+	static constexpr int m_TileSize{ 64 };
+	int m_NrTilesX{};
+	int m_NrTilesY{};
+
+	ThreadPool m_ThreadPool{};
+	StageTimers m_StageTimers; //one slot per pool thread
+
+	//Every pool thread counts into its own slot, summed into m_RasterStats at the end of the frame
+	struct alignas(64) RasterStatsSlot
+	{
+		RasterStats stats{};
+	};
+	std::vector<RasterStatsSlot> m_RasterStatsSlots;
+	static constexpr size_t m_VertexChunkSize{ 4096 }; //vertices per vertex stage task, a multiple of the SIMD width
+
+	//Output of one binning job, lives in that job's frame arena
+	struct BinnedTriangles
+	{
+		const TriangleSetup* pTriangles{};
+		uint32_t nrTriangles{};
+		const uint32_t* pTileOffsets{}; //first entry of every tile, the last one is the total
+		const uint32_t* pTileEntries{}; //indices into pTriangles, submission order within a tile
+	};
+
+	std::vector<BinnedTriangles> m_BinnedTriangles; //one per binning job
+	std::vector<FrameArena> m_FrameArenas; //one per binning job, reset when that job starts
+#if defined(DEBUG) || defined(_DEBUG)
+	uint64_t m_NrRenderedFrames{};
+	bool m_FrameArenasOverflowed{ false };
+#endif
+	std::vector<uint32_t> m_TriangleIdOffsets; //id of the first triangle of every job, the last entry is the total
+
+	//Hierarchical depth, conservative min/max of the depth buffer per 8x8 cell and per tile
+	static constexpr int m_HiZCellSize{ 8 };
+	int m_NrHiZCellsX{};
+	std::vector<DepthBounds> m_HiZCells;
+	std::vector<float> m_HiZTileMax;
+
+	//Fast clear, every tile clears its own color when it is rasterized and its depth only once a triangle reaches it
+	uint32_t m_ClearColor{};
+	std::vector<uint8_t> m_TileDepthCleared; //per tile, reset every frame
+
+	//Material of one pixel, sampled for the whole block before the pixels are shaded,
+	//with the constant factors of the lighting already applied
+	struct MaterialSample
+	{
+		ColorRGB lambert; //diffuse * light intensity / pi
+		Vector3 normal; //tangent space
+		float specular; //greyscale
+		float phongExponent; //gloss * shininess
+	};
+	ColorRGB PixelShading(const Vertex_Out& v, const MaterialSample& material) const;
+	void VertexTransformationFunctionW4(std::vector<MeshRasterizer>& meshes, const Camera& camera);
+	void TransformVertexChunk(MeshRasterizer& mesh, const Matrix& worldViewProjection, const Vector3& cameraOrigin, size_t first, size_t last) const;
+	void BinTriangles(uint32_t job, uint32_t nrJobs, RasterStats& stats);
+	bool SetupTriangle(TriangleSetup& triangle, const Vector4& screenA, const Vector4& screenB, const Vector4& screenC, VertexAttributes attributesA, VertexAttributes attributesB, VertexAttributes attributesC, RasterStats& stats) const;
+	void DepthPrePassTile(int tileIndex);
+	void RasterizeTile(int tileIndex, RasterStats& stats);
+	bool RasterizeTriangle(const TriangleSetup& triangle, uint32_t triangleId, int minX, int minY, int maxX, int maxY, RasterStats& stats);
+	void ShadeBlock(const TriangleSetup& triangle, int pixelIndex, int visible, const SimdFloat& x, const SimdFloat& y, const float* pDepthLanes);
+	void ResolveTile(int tileIndex, RasterStats& stats);
+	void VisualizeOverdrawTile(int tileIndex);
+	bool HasBinnedTriangles(int tileIndex) const;
+	void ClearTileColor(int tileIndex);
+	void ClearTileDepth(int tileIndex);
+	const TriangleSetup& GetTriangle(uint32_t triangleId) const;
+	void UpdateHiZCell(int cellX, int cellY);
+	void UpdateHiZTile(int tileIndex);
+};
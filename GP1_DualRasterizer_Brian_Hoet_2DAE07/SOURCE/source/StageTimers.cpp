@@ -0,0 +1,66 @@
+#include "pch.h"
+#include "StageTimers.h"
+
+StageTimers::StageTimers(uint32_t nrThreads) :
+	m_Slots(nrThreads),
+	m_CalibrationTime{ std::chrono::steady_clock::now() },
+	m_CalibrationTicks{ GetTicks() }
+{
+	//Short first measurement of the tick rate, every frame refines it
+	while (std::chrono::steady_clock::now() - m_CalibrationTime < std::chrono::milliseconds{ 1 })
+	{
+	}
+	CalibrateTicks();
+}
+
+void StageTimers::BeginFrame()
+{
+	CalibrateTicks();
+	for (ThreadSlot& slot : m_Slots)
+	{
+		slot.ticks.fill(0);
+	}
+}
+
+double StageTimers::GetMilliseconds(PipelineStage stage) const
+{
+	uint64_t ticks{};
+	for (const ThreadSlot& slot : m_Slots)
+	{
+		ticks += slot.ticks[static_cast<int>(stage)];
+	}
+	return ticks * m_MillisecondsPerTick;
+}
+
+const char* StageTimers::GetName(PipelineStage stage)
+{
+	switch (stage)
+	{
+	case PipelineStage::Transform:
+		return "Transform";
+	case PipelineStage::Setup:
+		return "Setup";
+	case PipelineStage::Raster:
+		return "Raster";
+	case PipelineStage::Shade:
+		return "Shade";
+	case PipelineStage::Resolve:
+		return "Resolve";
+	case PipelineStage::Blit:
+		return "Blit";
+	case PipelineStage::Present:
+		return "Present";
+	default:
+		return "";
+	}
+}
+
+void StageTimers::CalibrateTicks()
+{
+	const std::chrono::duration<double, std::milli> elapsed{ std::chrono::steady_clock::now() - m_CalibrationTime };
+	const uint64_t elapsedTicks{ GetTicks() - m_CalibrationTicks };
+	if (elapsedTicks != 0)
+	{
+		m_MillisecondsPerTick = elapsed.count() / elapsedTicks;
+	}
+}
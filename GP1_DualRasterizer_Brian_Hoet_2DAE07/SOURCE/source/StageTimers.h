@@ -0,0 +1,124 @@
+#pragma once
+#include "ThreadPool.h"
+
+//Standard includes
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+//Define as 0 to compile every TIME_STAGE out, the timers then always read 0
+#if !defined(ENABLE_STAGE_TIMERS)
+#define ENABLE_STAGE_TIMERS 1
+#endif
+
+enum class PipelineStage
+{
+	Transform, //vertex stage
+	Setup, //clipping, triangle setup and binning
+	Raster, //coverage and depth tests, depth pre-pass included, shading excluded
+	Shade, //pixel shading and writing the color buffer
+	Resolve, //visibility buffer attribute fetch, shading excluded
+	Blit, //back buffer to window surface
+	Present, //window surface to screen
+	Count
+};
+
+//Time every pipeline stage took this frame, summed over all threads that worked on it.
+//Every thread pool thread adds to its own slot, so timing needs no locks or atomics.
+//A timer started inside another one is subtracted from the outer stage.
+class StageTimers final
+{
+public:
+	static constexpr int NrStages{ static_cast<int>(PipelineStage::Count) };
+
+	explicit StageTimers(uint32_t nrThreads);
+	~StageTimers() = default;
+
+	StageTimers(const StageTimers&) = delete;
+	StageTimers(StageTimers&&) noexcept = delete;
+	StageTimers& operator=(const StageTimers&) = delete;
+	StageTimers& operator=(StageTimers&&) noexcept = delete;
+
+	//Clears the slots, no timer may be running
+	void BeginFrame();
+	//Milliseconds since the last BeginFrame, thread times added up
+	double GetMilliseconds(PipelineStage stage) const;
+	static const char* GetName(PipelineStage stage);
+
+private:
+	//Own cache line per thread, so threads never write to the same line
+	struct alignas(64) ThreadSlot
+	{
+		std::array<uint64_t, NrStages> ticks{};
+		PipelineStage currentStage{ PipelineStage::Count };
+	};
+
+	//The time stamp counter where there is one: a few cycles to read, cheap enough to time every shaded block
+	static uint64_t GetTicks()
+	{
+#if defined(_M_X64) || defined(__x86_64__)
+		return __rdtsc();
+#else
+		return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+	}
+
+public:
+	class Scope final
+	{
+	public:
+		Scope(StageTimers& timers, PipelineStage stage) :
+			m_Slot{ timers.m_Slots[ThreadPool::GetCurrentThreadIndex()] },
+			m_Stage{ stage },
+			m_ParentStage{ m_Slot.currentStage },
+			m_StartTicks{ GetTicks() }
+		{
+			m_Slot.currentStage = stage;
+		}
+
+		~Scope()
+		{
+			const uint64_t ticks{ GetTicks() - m_StartTicks };
+			m_Slot.ticks[static_cast<int>(m_Stage)] += ticks;
+			if (m_ParentStage != PipelineStage::Count)
+			{
+				m_Slot.ticks[static_cast<int>(m_ParentStage)] -= ticks; //wraps back when the parent adds its own time
+			}
+			m_Slot.currentStage = m_ParentStage;
+		}
+
+		Scope(const Scope&) = delete;
+		Scope(Scope&&) noexcept = delete;
+		Scope& operator=(const Scope&) = delete;
+		Scope& operator=(Scope&&) noexcept = delete;
+
+	private:
+		ThreadSlot& m_Slot;
+		PipelineStage m_Stage;
+		PipelineStage m_ParentStage;
+		uint64_t m_StartTicks;
+	};
+
+private:
+	void CalibrateTicks();
+
+	std::vector<ThreadSlot> m_Slots;
+
+	//Ticks are converted with the rate measured against the steady clock since construction
+	std::chrono::steady_clock::time_point m_CalibrationTime;
+	uint64_t m_CalibrationTicks{};
+	double m_MillisecondsPerTick{};
+};
+
+#if ENABLE_STAGE_TIMERS
+#define TIME_STAGE(timers, stage) const StageTimers::Scope stageTimer{ timers, stage }
+#else
+#define TIME_STAGE(timers, stage)
+#endif
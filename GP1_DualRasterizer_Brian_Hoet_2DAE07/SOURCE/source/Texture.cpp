@@ -1,20 +1,25 @@
 #include "pch.h"
 #include "Texture.h"
-#include "Vector2.h"
+#include "Profiler.h"
 #include <assert.h>
+#include <cstring>
 
 
 using namespace dae;
 
 
+#if defined(_WIN32)
 Texture::Texture(ID3D11Device* pDevice, const std::string& path)
 {
-	m_pSurface = IMG_Load(path.c_str());
+	PROFILE_ZONE("Texture::Texture");
+	//The software renderer samples the same textures
+	LoadTexels(IMG_Load(path.c_str()));
 
+	//Same memory layout as the texels, level 0 comes first
 	const DXGI_FORMAT format{ DXGI_FORMAT_R8G8B8A8_UNORM };
 	D3D11_TEXTURE2D_DESC desc{};
-	desc.Width = m_pSurface->w;
-	desc.Height = m_pSurface->h;
+	desc.Width = GetWidth();
+	desc.Height = GetHeight();
 	desc.MipLevels = 1;
 	desc.ArraySize = 1;
 	desc.Format = format;
@@ -26,9 +31,9 @@ Texture::Texture(ID3D11Device* pDevice, const std::string& path)
 	desc.MiscFlags = 0;
 
 	D3D11_SUBRESOURCE_DATA initData{};
-	initData.pSysMem = m_pSurface->pixels;
-	initData.SysMemPitch = static_cast<UINT>(m_pSurface->pitch);
-	initData.SysMemSlicePitch = static_cast<UINT>(m_pSurface->h * m_pSurface->pitch);
+	initData.pSysMem = m_Texels.data();
+	initData.SysMemPitch = static_cast<UINT>(GetWidth() * sizeof(uint32_t));
+	initData.SysMemSlicePitch = static_cast<UINT>(GetHeight() * GetWidth() * sizeof(uint32_t));
 
 	HRESULT hr = pDevice->CreateTexture2D(&desc, &initData, &m_pResource);
 
@@ -39,13 +44,12 @@ Texture::Texture(ID3D11Device* pDevice, const std::string& path)
 	SRVDesc.Texture2D.MipLevels = 1;
 
 	hr = pDevice->CreateShaderResourceView(m_pResource, &SRVDesc, &m_pSRV);
-
-
-	m_pSurfacePixels = (uint32_t*)m_pSurface->pixels;
 }
+#endif
 
 Texture::~Texture()
 {
+#if defined(_WIN32)
 	if(m_pResource)
 	{
 		m_pResource->Release();
@@ -56,28 +60,26 @@ Texture::~Texture()
 		m_pSRV->Release();
 		m_pSRV = nullptr;
 	}
-	if(m_pSurface)
-	{
-		SDL_FreeSurface(m_pSurface);
-		m_pSurface = nullptr;
-	}
+#endif
 }
 
+#if defined(_WIN32)
 ID3D11ShaderResourceView* Texture::GetSRV() const
 {
 	return m_pSRV;
 }
+#endif
 
 
 //RASTERIZER
-Texture::Texture(SDL_Surface* pSurface) :
-	m_pSurface{ pSurface },
-	m_pSurfacePixels{ (uint32_t*)pSurface->pixels }
+Texture::Texture(SDL_Surface* pSurface)
 {
+	LoadTexels(pSurface);
 }
 
 Texture* Texture::LoadFromFile(const std::string& path)
 {
+	PROFILE_ZONE("Texture::LoadFromFile");
 	const auto loadedImage{ IMG_Load(path.c_str()) };
 	assert(loadedImage != nullptr && "There was no file found");
 
@@ -86,16 +88,66 @@ Texture* Texture::LoadFromFile(const std::string& path)
 }
 
 
-ColorRGB Texture::Sample(const dae::Vector2& uv) const
+int Texture::GetWidth() const
+{
+	return m_MipLevels[0].width;
+}
+
+int Texture::GetHeight() const
+{
+	return m_MipLevels[0].height;
+}
+
+const std::vector<uint32_t>& Texture::GetTexels() const
 {
-	Uint8 r, g, b;
+	return m_Texels;
+}
 
-	const size_t x{ static_cast<size_t>(uv.x * m_pSurface->w) };
-	const size_t y{ static_cast<size_t>(uv.y * m_pSurface->h) };
+void Texture::LoadTexels(SDL_Surface* pSurface)
+{
+	//One conversion at load, whatever the image format was, so sampling never goes through SDL
+	SDL_Surface* pConverted{ SDL_ConvertSurfaceFormat(pSurface, SDL_PIXELFORMAT_RGBA32, 0) };
+	SDL_FreeSurface(pSurface);
+	assert(pConverted != nullptr && "The texture could not be converted to RGBA8");
 
-	const Uint32 pixel{ m_pSurfacePixels[x + y * m_pSurface->w] };
+	m_MipLevels = TextureSampling::CreateMipChain(pConverted->w, pConverted->h);
+	m_Texels.resize(TextureSampling::GetNrTexels(m_MipLevels));
 
-	SDL_GetRGB(pixel, m_pSurface->format, &r, &g, &b);
+	//Rows of the surface can be padded
+	const TextureSampling::MipLevel& fullLevel{ m_MipLevels[0] };
+	for (int y{}; y < fullLevel.height; ++y)
+	{
+		const uint8_t* pRow{ static_cast<const uint8_t*>(pConverted->pixels) + size_t(y) * pConverted->pitch };
+		std::memcpy(&m_Texels[size_t(y) * fullLevel.width], pRow, fullLevel.width * sizeof(uint32_t));
+	}
+	SDL_FreeSurface(pConverted);
 
-	return { r / 255.f, g / 255.f, b / 255.f };
+	for (size_t levelIndex{ 1 }; levelIndex < m_MipLevels.size(); ++levelIndex)
+	{
+		const TextureSampling::MipLevel& source{ m_MipLevels[levelIndex - 1] };
+		const TextureSampling::MipLevel& level{ m_MipLevels[levelIndex] };
+
+		//Box filter of the 2x2 texels above, an odd last row or column is left out
+		for (int y{}; y < level.height; ++y)
+		{
+			for (int x{}; x < level.width; ++x)
+			{
+				uint32_t sum[4]{};
+				for (int texel{}; texel < 4; ++texel)
+				{
+					const int sourceX{ std::min(x * 2 + (texel & 1), source.width - 1) };
+					const int sourceY{ std::min(y * 2 + (texel >> 1), source.height - 1) };
+
+					const uint32_t sourceTexel{ m_Texels[TextureSampling::GetTexelIndex(source, sourceX, sourceY)] };
+					sum[0] += (sourceTexel >> RED_SHIFT) & 0xFF;
+					sum[1] += (sourceTexel >> GREEN_SHIFT) & 0xFF;
+					sum[2] += (sourceTexel >> BLUE_SHIFT) & 0xFF;
+					sum[3] += (sourceTexel >> ALPHA_SHIFT) & 0xFF;
+				}
+
+				m_Texels[TextureSampling::GetTexelIndex(level, x, y)] = ((sum[0] + 2) / 4) << RED_SHIFT | ((sum[1] + 2) / 4) << GREEN_SHIFT
+					| ((sum[2] + 2) / 4) << BLUE_SHIFT | ((sum[3] + 2) / 4) << ALPHA_SHIFT;
+			}
+		}
+	}
 }
@@ -1,16 +1,16 @@
 #pragma once
 
 #include <SDL_surface.h>
-#include "ColorRGB.h"
+#include "TextureSampling.h"
 
-using namespace dae;
+//Standard includes
+#include <vector>
 
-class Vector2;
+using namespace dae;
 
 class Texture final
 {
 public:
-	Texture(ID3D11Device* pDevice, const std::string& path);
 	~Texture();
 
 	Texture(const Texture&) = delete;
@@ -18,19 +18,38 @@ public:
 	Texture& operator=(const Texture&) = delete;
 	Texture& operator=(Texture&&) noexcept = delete;
 
+#if defined(_WIN32)
 	//DirectX
+	Texture(ID3D11Device* pDevice, const std::string& path);
 	ID3D11ShaderResourceView* GetSRV() const;
+#endif
 
 	//Rasterizer
-	Texture(SDL_Surface* pSurface);
-	ColorRGB Sample(const dae::Vector2& uv) const;
+	//The software renderer samples the maps baked into a MaterialTexture, this only holds their texels
+	Texture(SDL_Surface* pSurface); //converts the surface and frees it
+	int GetWidth() const;
+	int GetHeight() const;
+	//Every mip level as RGBA8, in the linear layout of TextureSampling::CreateMipChain: DirectX uploads level 0 as is
+	const std::vector<uint32_t>& GetTexels() const;
 	static Texture* LoadFromFile(const std::string& path);
 
+	//Every level is stored as RGBA8, red in the lowest byte, whatever format the image was loaded in
+	static constexpr int RED_SHIFT{ 0 };
+	static constexpr int GREEN_SHIFT{ 8 };
+	static constexpr int BLUE_SHIFT{ 16 };
+	static constexpr int ALPHA_SHIFT{ 24 };
+
 private:
+	void LoadTexels(SDL_Surface* pSurface); //frees the surface
+
+#if defined(_WIN32)
 	ID3D11Texture2D* m_pResource{};
 	ID3D11ShaderResourceView* m_pSRV{};
+#endif
 
-	SDL_Surface* m_pSurface{ nullptr };
-	uint32_t* m_pSurfacePixels{ nullptr };
+	//Software mip chain, built by both constructors.
+	//Level 0 is the loaded image, every next level is half the size down to 1x1, all in one block of texels
+	std::vector<TextureSampling::MipLevel> m_MipLevels{};
+	std::vector<uint32_t> m_Texels{};
 };
 
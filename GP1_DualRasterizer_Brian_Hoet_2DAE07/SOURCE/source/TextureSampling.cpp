@@ -0,0 +1,154 @@
+#include "pch.h"
+#include "TextureSampling.h"
+
+namespace TextureSampling
+{
+	namespace
+	{
+		//Texels the level takes up, with the padding of the tiles
+		size_t GetLevelSize(const MipLevel& level)
+		{
+			if (level.layout == TexelLayout::Linear)
+				return size_t(level.width) * level.height;
+
+			const size_t nrTilesY{ size_t(level.height + TILE_SIZE - 1) / TILE_SIZE };
+			return level.nrTilesX * nrTilesY * (TILE_SIZE * TILE_SIZE);
+		}
+	}
+
+	std::vector<MipLevel> CreateMipChain(int width, int height, TexelLayout layout)
+	{
+		auto createLevel = [layout](int levelWidth, int levelHeight, size_t firstTexel)
+		{
+			return MipLevel{ levelWidth, levelHeight, firstTexel, layout, (levelWidth + TILE_SIZE - 1) / TILE_SIZE };
+		};
+
+		std::vector<MipLevel> levels{ createLevel(width, height, 0) };
+		while (width > 1 || height > 1)
+		{
+			const MipLevel& above{ levels.back() };
+			const size_t firstTexel{ above.firstTexel + GetLevelSize(above) };
+			width = std::max(width / 2, 1);
+			height = std::max(height / 2, 1);
+			levels.push_back(createLevel(width, height, firstTexel));
+		}
+		return levels;
+	}
+
+	size_t GetNrTexels(const std::vector<MipLevel>& levels)
+	{
+		return levels.back().firstTexel + GetLevelSize(levels.back());
+	}
+
+	QuadFootprint GetFootprint(const QuadGradients& gradients, const std::vector<MipLevel>& levels, const SamplerState& sampler)
+	{
+		QuadFootprint footprint{};
+		const int lastLevel{ static_cast<int>(levels.size()) - 1 };
+
+		//Pixel steps in level 0 texels
+		const float width{ float(levels[0].width) };
+		const float height{ float(levels[0].height) };
+		const float lengthXSquared{ Square(gradients.dudx * width) + Square(gradients.dvdx * height) };
+		const float lengthYSquared{ Square(gradients.dudy * width) + Square(gradients.dvdy * height) };
+		const float majorSquared{ std::max(lengthXSquared, lengthYSquared) };
+
+		float levelOfDetail{ .5f * std::log2(majorSquared) };
+		if (sampler.filter == SamplerState::Filter::Anisotropic)
+		{
+			//As many taps as the footprint is longer than wide, each tap then only has to cover the short side
+			const float minorSquared{ std::min(lengthXSquared, lengthYSquared) };
+			const float ratio{ std::sqrt(majorSquared / minorSquared) };
+			footprint.nrTaps = ratio > 1.f ? static_cast<int>(std::ceil(std::min(ratio, float(sampler.maxAnisotropy)))) : 1;
+
+			const bool isMajorX{ lengthXSquared >= lengthYSquared };
+			footprint.tapStepU = (isMajorX ? gradients.dudx : gradients.dudy) / footprint.nrTaps;
+			footprint.tapStepV = (isMajorX ? gradients.dvdx : gradients.dvdy) / footprint.nrTaps;
+			levelOfDetail -= std::log2(float(footprint.nrTaps));
+		}
+
+		//Magnified (and NaN) stays on level 0
+		if (sampler.mipFilter == SamplerState::MipFilter::None || !(levelOfDetail > 0.f))
+			return footprint;
+
+		if (sampler.mipFilter == SamplerState::MipFilter::Nearest)
+		{
+			footprint.levels[0] = std::min(static_cast<int>(levelOfDetail + .5f), lastLevel);
+			return footprint;
+		}
+
+		const int level{ std::min(static_cast<int>(levelOfDetail), lastLevel) };
+		footprint.levels[0] = level;
+		if (level != lastLevel)
+		{
+			const float weight{ levelOfDetail - level };
+			footprint.levels[1] = level + 1;
+			footprint.levelWeights[0] = 1.f - weight;
+			footprint.levelWeights[1] = weight;
+		}
+		return footprint;
+	}
+
+	void GetTapTexels(SimdFloat u, SimdFloat v, const MipLevel* const* pQuadLevels, bool isBilinear, SamplerState::AddressMode addressMode,
+		TapTexels& tapTexels)
+	{
+		const SimdFloat zero{ 0.f };
+		const SimdFloat one{ 1.f };
+		const SimdFloat width{ QuadLanes(float(pQuadLevels[0]->width), float(pQuadLevels[1]->width)) };
+		const SimdFloat height{ QuadLanes(float(pQuadLevels[0]->height), float(pQuadLevels[1]->height)) };
+
+		if (addressMode == SamplerState::AddressMode::Wrap)
+		{
+			u = u - Floor(u);
+			v = v - Floor(v);
+		}
+
+		//Texel centers sit at .5, bilinear blends the 2x2 texels around the sample
+		SimdFloat x{ u * width }, y{ v * height };
+		if (isBilinear)
+		{
+			const SimdFloat half{ .5f };
+			x = x - half;
+			y = y - half;
+		}
+		SimdFloat x0{ Floor(x) }, y0{ Floor(y) };
+		tapTexels.fractionX = x - x0;
+		tapTexels.fractionY = y - y0;
+		SimdFloat x1{ x0 + one }, y1{ y0 + one };
+
+		if (addressMode == SamplerState::AddressMode::Wrap)
+		{
+			const int allLanes{ (1 << SIMD_WIDTH) - 1 };
+			x0 = Select(~LessEqualMask(zero, x0) & allLanes, x0 + width, x0);
+			y0 = Select(~LessEqualMask(zero, y0) & allLanes, y0 + height, y0);
+			x1 = Select(LessEqualMask(width, x1), x1 - width, x1);
+			y1 = Select(LessEqualMask(height, y1), y1 - height, y1);
+		}
+
+		//Clamps, and keeps the fetches in bounds for lanes with garbage or NaN coordinates: max returns 0 for NaN
+		auto toTexel = [&zero, &one](const SimdFloat& coordinate, const SimdFloat& size, uint32_t* pLanes)
+		{
+			TruncateToInt(Min(Max(coordinate, zero), size - one)).Store(pLanes);
+		};
+
+		uint32_t x0Lanes[SIMD_WIDTH], y0Lanes[SIMD_WIDTH], x1Lanes[SIMD_WIDTH], y1Lanes[SIMD_WIDTH];
+		toTexel(x0, width, x0Lanes);
+		toTexel(y0, height, y0Lanes);
+		if (isBilinear)
+		{
+			toTexel(x1, width, x1Lanes);
+			toTexel(y1, height, y1Lanes);
+		}
+
+		for (int lane{}; lane < SIMD_WIDTH; ++lane)
+		{
+			const MipLevel& level{ *pQuadLevels[GetQuad(lane)] };
+			tapTexels.indices[0][lane] = GetTexelIndex(level, x0Lanes[lane], y0Lanes[lane]);
+			if (isBilinear)
+			{
+				tapTexels.indices[1][lane] = GetTexelIndex(level, x1Lanes[lane], y0Lanes[lane]);
+				tapTexels.indices[2][lane] = GetTexelIndex(level, x0Lanes[lane], y1Lanes[lane]);
+				tapTexels.indices[3][lane] = GetTexelIndex(level, x1Lanes[lane], y1Lanes[lane]);
+			}
+		}
+	}
+}
@@ -0,0 +1,142 @@
+#pragma once
+#include "SamplerState.h"
+#include "Simd.h"
+
+//Standard includes
+#include <vector>
+
+using namespace dae;
+
+//Mip selection, anisotropic taps and texel addressing shared by the software textures,
+//which only differ in how their texels are stored and decoded
+namespace TextureSampling
+{
+	constexpr int NR_QUADS{ SIMD_BLOCK_WIDTH / 2 };
+
+	//uv steps to the next pixel to the right (x) and below (y), shared by the 4 pixels of a 2x2 quad
+	struct QuadGradients
+	{
+		float dudx;
+		float dvdx;
+		float dudy;
+		float dvdy;
+	};
+
+	//How the texels of a level are ordered in memory
+	enum class TexelLayout
+	{
+		Linear, //rows of texels, as the image was loaded
+		Tiled //4x4 tiles in rows, Z-order inside a tile, so a bilinear footprint mostly stays in one cache line whatever way the uvs walk
+	};
+	constexpr int TILE_SIZE{ 4 };
+
+	struct MipLevel
+	{
+		int width;
+		int height;
+		size_t firstTexel; //in the block of all levels
+		TexelLayout layout;
+		int nrTilesX; //tiled only, the last tile of a row or column is padded
+	};
+
+	//Level 0 is width x height, every next level is half the size down to 1x1, all one after the other in one block of texels.
+	//Textures of the same size and layout get the same chain, so their texels line up
+	std::vector<MipLevel> CreateMipChain(int width, int height, TexelLayout layout = TexelLayout::Linear);
+	size_t GetNrTexels(const std::vector<MipLevel>& levels);
+
+	//x and y must be inside the level
+	inline uint32_t GetTexelIndex(const MipLevel& level, uint32_t x, uint32_t y)
+	{
+		if (level.layout == TexelLayout::Linear)
+			return uint32_t(level.firstTexel) + x + y * level.width;
+
+		//The tile, then the 2x2 quad inside it, then the texel inside that quad
+		const uint32_t tile{ (y / TILE_SIZE) * level.nrTilesX + x / TILE_SIZE };
+		const uint32_t texelInTile{ (x & 1) | (y & 1) << 1 | (x & 2) << 1 | (y & 2) << 2 };
+		return uint32_t(level.firstTexel) + tile * (TILE_SIZE * TILE_SIZE) + texelInTile;
+	}
+
+	//Lanes 0, 1, 4 and 5 belong to the first 2x2 quad, lanes 2, 3, 6 and 7 to the second
+	inline int GetQuad(int lane)
+	{
+		return (lane & 3) >> 1;
+	}
+
+	inline SimdFloat QuadLanes(float quad0, float quad1)
+	{
+		return SimdFloat{ quad0, quad0, quad1, quad1, quad0, quad0, quad1, quad1 };
+	}
+
+	//What a quad samples: taps spread along its anisotropic axis, in one or two mip levels
+	struct QuadFootprint
+	{
+		int nrTaps{ 1 };
+		float tapStepU{};
+		float tapStepV{};
+		int levels[2]{};
+		float levelWeights[2]{ 1.f, 0.f };
+	};
+	QuadFootprint GetFootprint(const QuadGradients& gradients, const std::vector<MipLevel>& levels, const SamplerState& sampler);
+
+	//The texels one point or bilinear tap reads per lane, in the level of its quad.
+	//Lanes with garbage or NaN coordinates still get texels inside the level
+	struct TapTexels
+	{
+		uint32_t indices[4][SIMD_WIDTH]; //top left, top right, bottom left and bottom right, point only fills the first
+		SimdFloat fractionX;
+		SimdFloat fractionY;
+	};
+	void GetTapTexels(SimdFloat u, SimdFloat v, const MipLevel* const* pQuadLevels, bool isBilinear, SamplerState::AddressMode addressMode,
+		TapTexels& tapTexels);
+
+	//One channel of the 2x2 texels of a bilinear tap, in the order of TapTexels::indices
+	inline SimdFloat Bilinear(const SimdFloat* pTexels, const TapTexels& tapTexels)
+	{
+		const SimdFloat top{ pTexels[0] + (pTexels[1] - pTexels[0]) * tapTexels.fractionX };
+		const SimdFloat bottom{ pTexels[2] + (pTexels[3] - pTexels[2]) * tapTexels.fractionX };
+		return top + (bottom - top) * tapTexels.fractionY;
+	}
+
+	//Calls sampleTap(tapU, tapV, pQuadLevels, weight) for every tap in every mip level the sampler asks for,
+	//per lane the weights add up to 1
+	template<typename SampleTap>
+	void SampleFootprints(const SimdFloat& u, const SimdFloat& v, const QuadGradients* pQuadGradients, const SamplerState& sampler,
+		const std::vector<MipLevel>& levels, SampleTap sampleTap)
+	{
+		QuadFootprint footprints[NR_QUADS]{};
+		int maxNrTaps{ 1 };
+		for (int quad{}; quad < NR_QUADS; ++quad)
+		{
+			footprints[quad] = GetFootprint(pQuadGradients[quad], levels, sampler);
+			maxNrTaps = std::max(maxNrTaps, footprints[quad].nrTaps);
+		}
+
+		for (int levelIndex{}; levelIndex < 2; ++levelIndex)
+		{
+			if (footprints[0].levelWeights[levelIndex] == 0.f && footprints[1].levelWeights[levelIndex] == 0.f)
+				continue;
+
+			const MipLevel* quadLevels[NR_QUADS]{ &levels[footprints[0].levels[levelIndex]], &levels[footprints[1].levels[levelIndex]] };
+			for (int tap{}; tap < maxNrTaps; ++tap)
+			{
+				//Taps centered on the pixel, a quad that is out of taps weighs 0
+				float tapOffsets[NR_QUADS], tapWeights[NR_QUADS];
+				for (int quad{}; quad < NR_QUADS; ++quad)
+				{
+					const QuadFootprint& footprint{ footprints[quad] };
+					tapOffsets[quad] = tap - (footprint.nrTaps - 1) * .5f;
+					tapWeights[quad] = tap < footprint.nrTaps ? footprint.levelWeights[levelIndex] / footprint.nrTaps : 0.f;
+				}
+
+				SimdFloat tapU{ u }, tapV{ v };
+				if (maxNrTaps > 1)
+				{
+					tapU = u + QuadLanes(tapOffsets[0] * footprints[0].tapStepU, tapOffsets[1] * footprints[1].tapStepU);
+					tapV = v + QuadLanes(tapOffsets[0] * footprints[0].tapStepV, tapOffsets[1] * footprints[1].tapStepV);
+				}
+
+				sampleTap(tapU, tapV, quadLevels, QuadLanes(tapWeights[0], tapWeights[1]));
+			}
+		}
+	}
+}
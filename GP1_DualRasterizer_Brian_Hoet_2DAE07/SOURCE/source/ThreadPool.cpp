@@ -0,0 +1,111 @@
+#include "pch.h"
+#include "ThreadPool.h"
+#include "Profiler.h"
+
+ThreadPool::ThreadPool(uint32_t nrThreads)
+{
+	if (nrThreads == 0)
+	{
+		nrThreads = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	//The calling thread is worker 0, so spawn one less
+	m_NrActiveWorkers = nrThreads - 1;
+	m_Threads.reserve(nrThreads - 1);
+	for (uint32_t threadIndex{ 1 }; threadIndex < nrThreads; ++threadIndex)
+	{
+		m_Threads.emplace_back(&ThreadPool::WorkerLoop, this, threadIndex);
+	}
+
+	//Workers set up their profiler buffer first, that allocation must not land in the middle of a frame
+	std::unique_lock lock{ m_Mutex };
+	m_DoneCondition.wait(lock, [this] { return m_NrActiveWorkers == 0; });
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard lock{ m_Mutex };
+		m_Quit = true;
+	}
+	m_WakeCondition.notify_all();
+
+	for (std::thread& thread : m_Threads)
+	{
+		thread.join();
+	}
+}
+
+void ThreadPool::Dispatch(uint32_t count, TaskFunction pTask, const void* pContext)
+{
+	if (count == 0)
+		return;
+
+	//Nothing to share, avoid waking the workers
+	if (m_Threads.empty() || count == 1)
+	{
+		for (uint32_t index{}; index < count; ++index)
+		{
+			pTask(pContext, index, 0);
+		}
+		return;
+	}
+
+	{
+		std::lock_guard lock{ m_Mutex };
+		m_pTask = pTask;
+		m_pContext = pContext;
+		m_Count = count;
+		m_NextIndex.store(0, std::memory_order_relaxed);
+		m_NrActiveWorkers = static_cast<uint32_t>(m_Threads.size());
+		++m_Generation;
+	}
+	m_WakeCondition.notify_all();
+
+	RunTasks(0);
+
+	std::unique_lock lock{ m_Mutex };
+	m_DoneCondition.wait(lock, [this] { return m_NrActiveWorkers == 0; });
+}
+
+void ThreadPool::WorkerLoop(uint32_t threadIndex)
+{
+	m_CurrentThreadIndex = threadIndex;
+	Profiler::Get().SetThreadName("Worker " + std::to_string(threadIndex));
+	{
+		std::lock_guard lock{ m_Mutex };
+		if (--m_NrActiveWorkers == 0)
+		{
+			m_DoneCondition.notify_one();
+		}
+	}
+
+	uint64_t generation{};
+	while (true)
+	{
+		{
+			std::unique_lock lock{ m_Mutex };
+			m_WakeCondition.wait(lock, [&] { return m_Quit || m_Generation != generation; });
+			if (m_Quit)
+				return;
+
+			generation = m_Generation;
+		}
+
+		RunTasks(threadIndex);
+
+		std::lock_guard lock{ m_Mutex };
+		if (--m_NrActiveWorkers == 0)
+		{
+			m_DoneCondition.notify_one();
+		}
+	}
+}
+
+void ThreadPool::RunTasks(uint32_t threadIndex)
+{
+	for (uint32_t index{ m_NextIndex.fetch_add(1) }; index < m_Count; index = m_NextIndex.fetch_add(1))
+	{
+		m_pTask(m_pContext, index, threadIndex);
+	}
+}
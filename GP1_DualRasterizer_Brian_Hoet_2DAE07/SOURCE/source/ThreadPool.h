@@ -0,0 +1,60 @@
+#pragma once
+
+//Standard includes
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//Persistent worker threads for the software pipeline.
+//The calling thread always takes part in the work as thread index 0.
+class ThreadPool final
+{
+public:
+	explicit ThreadPool(uint32_t nrThreads = 0); //0 = one thread per hardware core
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool(ThreadPool&&) noexcept = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+	ThreadPool& operator=(ThreadPool&&) noexcept = delete;
+
+	uint32_t GetNrThreads() const { return static_cast<uint32_t>(m_Threads.size()) + 1; }
+	//threadIndex of the calling thread, 0 on any thread that is not a worker
+	static uint32_t GetCurrentThreadIndex() { return m_CurrentThreadIndex; }
+
+	//Calls func(index, threadIndex) for every index in [0, count) and blocks until all are done.
+	//Indices are handed out dynamically, so a slow index does not hold back the other threads.
+	template<typename Func>
+	void ParallelFor(uint32_t count, const Func& func)
+	{
+		Dispatch(count, [](const void* pContext, uint32_t index, uint32_t threadIndex)
+			{
+				(*static_cast<const Func*>(pContext))(index, threadIndex);
+			}, &func);
+	}
+
+private:
+	using TaskFunction = void(*)(const void* pContext, uint32_t index, uint32_t threadIndex);
+
+	void Dispatch(uint32_t count, TaskFunction pTask, const void* pContext);
+	void WorkerLoop(uint32_t threadIndex);
+	void RunTasks(uint32_t threadIndex);
+
+	std::vector<std::thread> m_Threads{};
+	static inline thread_local uint32_t m_CurrentThreadIndex{};
+
+	std::mutex m_Mutex{};
+	std::condition_variable m_WakeCondition{};
+	std::condition_variable m_DoneCondition{};
+	uint64_t m_Generation{};
+	uint32_t m_NrActiveWorkers{};
+	bool m_Quit{ false };
+
+	TaskFunction m_pTask{ nullptr };
+	const void* m_pContext{ nullptr };
+	uint32_t m_Count{};
+	std::atomic<uint32_t> m_NextIndex{};
+};
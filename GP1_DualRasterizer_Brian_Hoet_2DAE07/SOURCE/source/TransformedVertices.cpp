@@ -0,0 +1,24 @@
+#include "pch.h"
+#include "TransformedVertices.h"
+
+void TransformedVertices::Resize(size_t nrVertices)
+{
+	m_Size = nrVertices;
+
+	const size_t pitch{ (nrVertices + m_VertexGranularity - 1) / m_VertexGranularity * m_VertexGranularity };
+	if (pitch <= m_Pitch)
+		return;
+
+	m_Pitch = pitch;
+	m_pData.reset(static_cast<float*>(::operator new(NrStreams * m_Pitch * sizeof(float), std::align_val_t{ m_Alignment })));
+}
+
+Vector4 TransformedVertices::GetClipPosition(size_t index) const
+{
+	return Vector4{ GetStream(ClipX)[index], GetStream(ClipY)[index], GetStream(ClipZ)[index], GetStream(ClipW)[index] };
+}
+
+Vector4 TransformedVertices::GetScreenPosition(size_t index) const
+{
+	return Vector4{ GetStream(ScreenX)[index], GetStream(ScreenY)[index], GetStream(ScreenZ)[index], GetStream(ClipW)[index] };
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include "DataTypes.h"
+
+//Standard includes
+#include <memory>
+#include <new>
+
+//Output of the software vertex stage, one float stream per component (structure of arrays).
+//Every stream starts on a SIMD boundary and holds a multiple of 8 vertices,
+//so the vertex stage can read and write whole registers.
+class TransformedVertices final
+{
+public:
+	enum Stream
+	{
+		ClipX,
+		ClipY,
+		ClipZ,
+		ClipW,
+		ScreenX, //pixels
+		ScreenY, //pixels
+		ScreenZ, //NDC depth, screen w is ClipW
+		FirstAttribute, //NrVertexAttributes streams in VertexAttribute order
+		Outcode = FirstAttribute + NrVertexAttributes, //int32 clip outcodes
+		NrStreams
+	};
+
+	static constexpr size_t m_Alignment{ 32 };
+	static constexpr size_t m_VertexGranularity{ m_Alignment / sizeof(float) };
+
+	TransformedVertices() = default;
+	~TransformedVertices() = default;
+
+	TransformedVertices(const TransformedVertices&) = delete;
+	TransformedVertices(TransformedVertices&&) noexcept = default;
+	TransformedVertices& operator=(const TransformedVertices&) = delete;
+	TransformedVertices& operator=(TransformedVertices&&) noexcept = default;
+
+	//Contents are undefined afterwards, only reallocates when growing
+	void Resize(size_t nrVertices);
+	size_t GetSize() const { return m_Size; }
+	size_t GetPitch() const { return m_Pitch; } //floats between the starts of two streams
+
+	float* GetStream(Stream stream) { return m_pData.get() + stream * m_Pitch; }
+	const float* GetStream(Stream stream) const { return m_pData.get() + stream * m_Pitch; }
+	int32_t* GetOutcodes() { return reinterpret_cast<int32_t*>(GetStream(Outcode)); }
+	const int32_t* GetOutcodes() const { return reinterpret_cast<const int32_t*>(GetStream(Outcode)); }
+
+	Vector4 GetClipPosition(size_t index) const;
+	Vector4 GetScreenPosition(size_t index) const;
+	VertexAttributes GetAttributes(size_t index) const { return VertexAttributes{ GetStream(FirstAttribute) + index, m_Pitch }; }
+
+private:
+	struct AlignedDeleter
+	{
+		void operator()(float* pData) const { ::operator delete(pData, std::align_val_t{ m_Alignment }); }
+	};
+
+	std::unique_ptr<float, AlignedDeleter> m_pData{};
+	size_t m_Size{};
+	size_t m_Pitch{};
+};
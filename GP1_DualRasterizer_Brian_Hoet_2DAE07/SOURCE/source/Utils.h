@@ -1,16 +1,20 @@
 #pragma once
 #include <fstream>
+#include <map>
+#include <tuple>
 #include "Math.h"
+#include "Profiler.h"
 
 namespace dae
 {
 	namespace Utils
 	{
-		//Just parses vertices and indices
+		//Just parses vertices and indices, face corners with the same position/uv/normal indices share one vertex
 #pragma warning(push)
 #pragma warning(disable : 4505) //Warning unreferenced local function
 		static bool ParseOBJ(const std::string& filename, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, bool flipAxisAndWinding = true)
 		{
+			PROFILE_ZONE("Utils::ParseOBJ");
 			std::ifstream file(filename);
 			if (!file)
 				return false;
@@ -18,6 +22,7 @@ namespace dae
 			std::vector<Vector3> positions{};
 			std::vector<Vector3> normals{};
 			std::vector<Vector2> UVs{};
+			std::map<std::tuple<size_t, size_t, size_t>, uint32_t> uniqueVertices{};
 
 			vertices.clear();
 			indices.clear();
@@ -65,11 +70,14 @@ namespace dae
 					//
 					// Faces or triangles
 					Vertex vertex{};
-					size_t iPosition, iTexCoord, iNormal;
+					size_t iPosition{}, iTexCoord{}, iNormal{};
 
 					uint32_t tempIndices[3];
 					for (size_t iFace = 0; iFace < 3; iFace++)
 					{
+						iTexCoord = 0;
+						iNormal = 0;
+
 						// OBJ format uses 1-based arrays
 						file >> iPosition;
 						vertex.position = positions[iPosition - 1];
@@ -95,8 +103,13 @@ namespace dae
 							}
 						}
 
-						vertices.push_back(vertex);
-						tempIndices[iFace] = uint32_t(vertices.size()) - 1;
+						//Reuse the vertex if this corner was seen before
+						const auto [it, isNew] = uniqueVertices.try_emplace({ iPosition, iTexCoord, iNormal }, uint32_t(vertices.size()));
+						if (isNew)
+						{
+							vertices.push_back(vertex);
+						}
+						tempIndices[iFace] = it->second;
 						//indices.push_back(uint32_t(vertices.size()) - 1);
 					}
 
@@ -135,6 +148,9 @@ namespace dae
 				const Vector2 diffX = Vector2(uv1.x - uv0.x, uv2.x - uv0.x);
 				const Vector2 diffY = Vector2(uv1.y - uv0.y, uv2.y - uv0.y);
 				float r = 1.f / Vector2::Cross(diffX, diffY);
+				//Faces without uv area have no tangent, their inf/NaN would spread to every face sharing a vertex
+				if (!std::isfinite(r))
+					continue;
 
 				Vector3 tangent = (edge0 * diffY.y - edge1 * diffY.x) * r;
 				vertices[index0].tangent += tangent;
@@ -145,7 +161,18 @@ namespace dae
 			//Create the Tangents (reject)
 			for (auto& v : vertices)
 			{
-				v.tangent = Vector3::Reject(v.tangent, v.normal).Normalized();
+				const Vector3 tangent{ Vector3::Reject(v.tangent, v.normal) };
+				const float tangentSqrLength{ tangent.SqrMagnitude() };
+				if (tangentSqrLength > 0.f && std::isfinite(tangentSqrLength))
+				{
+					v.tangent = tangent / std::sqrt(tangentSqrLength);
+				}
+				else
+				{
+					//Only faces without uv area, or opposite tangents that cancel out: any direction along the surface will do
+					const Vector3 axis{ std::abs(v.normal.x) < .9f ? Vector3::UnitX : Vector3::UnitY };
+					v.tangent = Vector3::Reject(axis, v.normal).Normalized();
+				}
 
 				if(flipAxisAndWinding)
 				{
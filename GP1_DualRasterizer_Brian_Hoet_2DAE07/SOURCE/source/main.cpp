@@ -6,6 +6,7 @@
 
 #undef main
 #include "Renderer.h"
+#include "Profiler.h"
 
 using namespace dae;
 
@@ -39,6 +40,7 @@ int main(int argc, char* args[])
 		return 1;
 
 	//Initialize "framework"
+	Profiler::Get().SetThreadName("Main");
 	const auto pTimer = new Timer();
 	const auto pRenderer = new Renderer(pWindow);
 
@@ -84,6 +86,14 @@ int main(int argc, char* args[])
 					pRenderer->ToggleNor();
 					break;
 
+					case SDL_SCANCODE_M:
+					pRenderer->ToggleMipFilter();
+					break;
+
+					case SDL_SCANCODE_U:
+					pRenderer->ToggleAddressMode();
+					break;
+
 					case SDL_SCANCODE_F7:
 					pRenderer->ToggleBuffer();
 					break;
@@ -92,6 +102,10 @@ int main(int argc, char* args[])
 					pRenderer->ToggleBoxVisual();
 					break;
 
+					case SDL_SCANCODE_O:
+					pRenderer->ToggleOverdraw();
+					break;
+
 					case SDL_SCANCODE_F9:
 					pRenderer->ToggleCullMode();
 					break;
@@ -105,6 +119,18 @@ int main(int argc, char* args[])
 					pRenderer->ToggleFPS(g_PrintFPS);
 					break;
 
+					case SDL_SCANCODE_P:
+					pRenderer->ToggleShadingPath();
+					break;
+
+					case SDL_SCANCODE_T:
+					pRenderer->ToggleStageTimes();
+					break;
+
+					case SDL_SCANCODE_C:
+					pRenderer->WriteTrace();
+					break;
+
 					case SDL_SCANCODE_I:
 					pRenderer->PrintText();
 					break;
@@ -131,6 +157,7 @@ int main(int argc, char* args[])
 			{
 				printTimer = 0.f;
 				std::cout << "dFPS: " << pTimer->GetdFPS() << std::endl;
+				pRenderer->PrintStageTimes();
 			}
 		}
 	}
@@ -10,15 +10,17 @@
 
 // SDL Headers
 #include "SDL.h"
-#include "SDL_syswm.h"
 #include "SDL_surface.h"
 #include "SDL_image.h"
 
-// DirectX Headers
+// DirectX Headers, the software renderer and the benchmark also build without them
+#if defined(_WIN32)
+#include "SDL_syswm.h"
 #include <dxgi.h>
 #include <d3d11.h>
 #include <d3dcompiler.h>
 #include <d3dx11effect.h>
+#endif
 
 // Framework Headers
 #include "Timer.h"